@@ -0,0 +1,98 @@
+//*************************************************************************************
+/** \file estop.cc
+ *	Emergency stop input. A normally closed switch from PE4 (INT4, Arduino pin 2) to
+ *	ground is opened to stop; a broken wire stops the rig as well. The interrupt
+ *	routine is in timescape.cc with the other ISRs.
+ *
+ *	Reaction time: INT4 is a higher priority vector than all the timer interrupts, so
+ *	the worst case is the longest piece of code that runs with interrupts off (another
+ *	ISR already running, or a cli() section) plus the 4 cycle response and the ISR
+ *	prologue. That hasn't been measured; the Timer 5 sequencer ISR is the likely
+ *	longest. estop_isr_ticks only records how long the ISR itself took to get the
+ *	outputs off, so the time from the switch opening has to be checked on the bench
+ *	with a scope on PE4 and the step pins.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdlib.h>			// Standard C library
+#include <avr/io.h>			// AVR IO library
+#include <avr/interrupt.h>	// Interrupt handling functions
+#include "rs232.h"			// Serial Port library
+#include "estop.h"			// e-stop h file include
+
+#define ESTOP_DDR			DDRE		//Data Direction Register for e-stop input
+#define ESTOP_DDR_BIT		DDE4		//Bit for Data direction register for e-stop input
+#define ESTOP_PORT			PORTE		//Port register, used for the pull-up
+#define ESTOP_PORT_BIT		PORTE4		//Port bit for the pull-up
+#define ESTOP_PIN			PINE		//Pin for reading state of the e-stop input
+#define ESTOP_PIN_BIT		PINE4		//pin register for reading state of the e-stop input
+
+
+//Constructor
+//-------------------------------------------------------------------------------------
+/** This is the constructor of the estop class. It sets the pin up as an input with
+ *	pull-up and turns on INT4 for a rising edge (switch opening). If the switch is
+ *	already open at power up the fault is latched straight away.
+ *  @param p_ser	A pointer to a serial port for messages
+ */
+estop::estop(base_text_serial* p_ser)
+{
+	p_serial = p_ser;				// copy serial pointer
+
+	//input with pull-up
+	ESTOP_DDR &= ~(1<<ESTOP_DDR_BIT);
+	ESTOP_PORT |= (1<<ESTOP_PORT_BIT);
+
+	//INT4 on rising edge
+	EICRB |= (1<<ISC41) | (1<<ISC40);
+	EIFR = (1<<INTF4);
+	EIMSK |= (1<<INT4);
+
+	if (input_active())
+	{
+		estop_latched = true;
+	}
+
+	*p_serial <<endl <<"E-Stop setup complete!!";
+}
+
+//-------------------------------------------------------------------------------------
+/** This method reads the e-stop switch.
+ *  @return true while the switch is open (stop requested)
+ */
+bool estop::input_active()
+{
+	return (ESTOP_PIN & (1<<ESTOP_PIN_BIT)) ? true : false;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method tells whether the e-stop fault is latched.
+ *  @return true if the e-stop has fired and hasn't been acknowledged
+ */
+bool estop::is_latched()
+{
+	return estop_latched;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method clears the fault, but only once the switch is closed again.
+ *  @return true if the fault was cleared
+ */
+bool estop::acknowledge()
+{
+	if (input_active())
+	{
+		return false;
+	}
+
+	estop_latched = false;
+	*p_serial <<endl <<"E-Stop cleared, ISR took " <<(estop_isr_ticks / 2) <<"us to stop outputs";
+	return true;
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
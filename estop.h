@@ -0,0 +1,36 @@
+//*************************************************************************************
+/** \file estop.h
+ *	Emergency stop input. A normally closed switch from PE4 (INT4, Arduino pin 2) to
+ *	ground is opened to stop; a broken wire stops the rig as well. The interrupt
+ *	routine in timescape.cc turns off the step outputs and the shutter and latches a
+ *	fault which task_navigation has to acknowledge before anything moves again.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _ESTOP_H_
+#define _ESTOP_H_                     	///< Prevents multiple inclusion of file
+
+extern volatile bool estop_latched;			// set by the e-stop ISR, cleared by acknowledge()
+extern volatile uint16_t estop_isr_ticks;	// Timer 3 ticks from ISR entry to outputs off
+
+class estop
+{
+	protected:
+		base_text_serial* p_serial;		//Variable to store passed serial port pointer
+
+	public:
+		estop(base_text_serial*);		//Constructor sets up the input and interrupt
+		bool input_active();			//true while the switch is open
+		bool is_latched();				//true until the fault is acknowledged
+		bool acknowledge();				//clear the fault if the switch is closed again
+
+};
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,337 @@
+//*************************************************************************************
+/** \file fixed_point.cc
+ *	Integer math helpers for the motion planner. The ATmega2560 has no floating point
+ *	unit, so anything the planner needs beyond + - * / is done here in fixed point.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdlib.h>			// Standard C library
+#include <avr/pgmspace.h>	// Tables kept in flash
+#include "fixed_point.h"	// Header for this file
+
+
+/// atan(k/32) for k = 0..32 in binary angle units (65536 per turn)
+static const uint16_t atan_table[33] PROGMEM =
+{
+	0, 326, 651, 975, 1297, 1617, 1933, 2246, 2555, 2860, 3159, 3453, 3742, 4025, 4302,
+	4572, 4836, 5094, 5344, 5589, 5826, 6058, 6282, 6500, 6712, 6917, 7117, 7310, 7498,
+	7679, 7856, 8026, 8192
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the base 2 logarithm of a number in Q8.8 format. The integer
+ *	part is the position of the highest set bit and the fraction is the next 8 bits of
+ *	the mantissa, which is a straight line between powers of two (error < 0.09).
+ *  @param x	The number to take the logarithm of
+ *  @return log2(x) * 256, or 0 if x is 0
+ */
+uint16_t fx_log2_q8(uint32_t x)
+{
+	uint8_t msb = 0;			//position of highest set bit
+	uint32_t tmp = x;			//scratch copy for finding the msb
+	uint8_t frac;				//8 bit mantissa below the msb
+
+	if (x == 0)
+	{
+		return 0;
+	}
+
+	while (tmp >>= 1)
+	{
+		msb++;
+	}
+
+	if (msb >= 8)
+	{
+		frac = (uint8_t)(x >> (msb - 8));
+	}
+	else
+	{
+		frac = (uint8_t)(x << (8 - msb));
+	}
+
+	return ((uint16_t)msb << 8) | frac;
+}
+
+
+/// 2^(k/16) for k = 0..16 in Q14
+static const uint16_t pow2_table[17] PROGMEM =
+{
+	16384, 17109, 17867, 18658, 19484, 20347, 21247, 22188, 23170, 24196, 25268, 26386,
+	27554, 28774, 30048, 31379, 32768
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the base 2 logarithm of a number in Q16.16 format. It is
+ *	slower than fx_log2_q8() but good to 0.00003 (2/65536), which is what exposure
+ *	ramps need. The mantissa is normalised to [1, 2) and squared once per fraction
+ *	bit; each time the square reaches 2 the next bit of the logarithm is a 1. The
+ *	mantissa is kept in Q30 so the rounding of 16 squares doesn't add up.
+ *  @param x	The number to take the logarithm of
+ *  @return log2(x) * 65536, or 0 if x is 0
+ */
+int32_t fx_log2_q16(uint32_t x)
+{
+	uint8_t msb = 0;			//position of highest set bit
+	uint32_t tmp = x;			//scratch copy for finding the msb
+	uint32_t mant;				//mantissa in Q30, 1 <= mant < 2
+	int32_t result;
+
+	if (x == 0)
+	{
+		return 0;
+	}
+
+	while (tmp >>= 1)
+	{
+		msb++;
+	}
+
+	if (msb >= 30)
+	{
+		mant = x >> (msb - 30);
+	}
+	else
+	{
+		mant = x << (30 - msb);
+	}
+
+	result = (int32_t)msb << 16;
+	for (uint32_t bit = 0x8000; bit != 0; bit >>= 1)
+	{
+		mant = (uint32_t)(((uint64_t)mant * mant + (1UL << 29)) >> 30);
+		if (mant >= 0x80000000UL)
+		{
+			mant = (mant + 1) >> 1;
+			result |= bit;
+		}
+	}
+
+	return result;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function multiplies a number by a power of two given in Q16.16, which is how
+ *	a value is moved along a ramp that is linear in log2 (stops of exposure). The
+ *	fraction comes from the table with straight line interpolation (error < 0.1%).
+ *	The product is kept whole until the end, so a small number scaled up keeps its
+ *	precision, and the result is rounded to the nearest count.
+ *  @param x	The number to scale
+ *  @param e	The power of two to scale by, Q16.16, any sign
+ *  @return x * 2^(e / 65536), or 0xFFFFFFFF if that doesn't fit
+ */
+uint32_t fx_scale_pow2(uint32_t x, int32_t e)
+{
+	int16_t whole = (int16_t)(e >> 16) - 14;	//integer part less the Q14 of mult
+	uint16_t frac = (uint16_t)e;			//fraction, 0 to 0xFFFF
+	uint8_t index = frac >> 12;				//table entry below the fraction
+	uint16_t lo, hi;
+	uint32_t mult;							//2^fraction in Q14
+	uint64_t product;						//x * mult, 46 bits at most
+
+	lo = pgm_read_word(&pow2_table[index]);
+	hi = pgm_read_word(&pow2_table[index + 1]);
+	mult = lo + (((uint32_t)(hi - lo) * (frac & 0x0FFF)) >> 12);
+
+	product = (uint64_t)x * mult;
+
+	if (whole >= 0)
+	{
+		if ((whole >= 32) || (product > (0xFFFFFFFFUL >> whole)))
+		{
+			return 0xFFFFFFFFUL;
+		}
+		return (uint32_t)product << whole;
+	}
+
+	if (whole <= -47)
+	{
+		return 0;
+	}
+	product = (product + ((uint64_t)1 << (-whole - 1))) >> (-whole);
+	return (product > 0xFFFFFFFFUL) ? 0xFFFFFFFFUL : (uint32_t)product;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns atan(num/den) for 0 <= num <= den, read from the table with
+ *	straight line interpolation between entries (error < 0.02 degree).
+ *  @param num	Numerator, no bigger than den
+ *  @param den	Denominator, bigger than 0
+ *  @return The angle in binary angle units, 0 to FX_BAM_45
+ */
+static uint16_t fx_atan_unit(uint32_t num, uint32_t den)
+{
+	uint16_t ratio;				//num/den in Q12
+	uint8_t index;				//table entry below the ratio
+	uint8_t frac;				//position between index and index + 1, Q7
+	uint16_t lo, hi;			//table entries either side of the ratio
+
+	//scale both down so the shift below can't overflow
+	while (den > 0x7FFFFUL)
+	{
+		num >>= 1;
+		den >>= 1;
+	}
+
+	ratio = (uint16_t)((num << 12) / den);
+	index = ratio >> 7;
+	frac = ratio & 0x7F;
+
+	lo = pgm_read_word(&atan_table[index]);
+	if (index >= 32)
+	{
+		return lo;
+	}
+	hi = pgm_read_word(&atan_table[index + 1]);
+
+	return lo + (uint16_t)(((uint32_t)(hi - lo) * frac) >> 7);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the angle of the point (x, y) from the x axis, for points in
+ *	front of the origin (x > 0). Angles beyond 45 degrees use atan(a) = 90 - atan(1/a)
+ *	so the table lookup always has a ratio of 1 or less.
+ *  @param y	Sideways offset, any sign
+ *  @param x	Forward distance, must be bigger than 0
+ *  @return The angle in binary angle units, -FX_BAM_90 to FX_BAM_90
+ */
+int16_t fx_atan2_bam(int32_t y, int32_t x)
+{
+	uint32_t ay = (y < 0) ? -y : y;		//size of the offset
+	uint16_t angle;
+
+	if (x <= 0)
+	{
+		return (y < 0) ? -FX_BAM_90 : FX_BAM_90;
+	}
+
+	if (ay <= (uint32_t)x)
+	{
+		angle = fx_atan_unit(ay, x);
+	}
+	else
+	{
+		angle = FX_BAM_90 - fx_atan_unit(x, ay);
+	}
+
+	return (y < 0) ? -(int16_t)angle : (int16_t)angle;
+}
+
+/// sin(k * 90 / 64 degrees) for k = 0..64 in Q15
+static const uint16_t sin_table[65] PROGMEM =
+{
+	0, 804, 1608, 2411, 3212, 4011, 4808, 5602, 6393, 7180, 7962, 8740, 9512, 10279, 11039,
+	11793, 12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531, 18205, 18868, 19520,
+	20160, 20788, 21403, 22006, 22595, 23170, 23732, 24279, 24812, 25330, 25833, 26320,
+	26791, 27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957, 30274, 30572, 30853,
+	31114, 31357, 31581, 31786, 31972, 32138, 32286, 32413, 32522, 32610, 32679, 32729,
+	32758, 32768
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the sine of an angle, read from a quarter wave table with
+ *	straight line interpolation between entries (error < 0.0001).
+ *  @param angle	The angle in binary angle units, any value
+ *  @return sin(angle) in Q15, -FX_ONE_Q15 to FX_ONE_Q15
+ */
+int32_t fx_sin_q15(uint16_t angle)
+{
+	uint16_t quarter = angle & (FX_BAM_90 - 1);		//angle into its quarter turn
+	uint8_t index;									//table entry below the angle
+	uint8_t frac;									//position between entries, Q8
+	uint16_t lo, hi;
+	int32_t result;
+
+	//the second and fourth quarters run the table backwards
+	if (angle & FX_BAM_90)
+	{
+		quarter = FX_BAM_90 - quarter;
+	}
+
+	index = quarter >> 8;
+	frac = quarter & 0xFF;
+
+	lo = pgm_read_word(&sin_table[index]);
+	if (index >= 64)
+	{
+		result = lo;
+	}
+	else
+	{
+		hi = pgm_read_word(&sin_table[index + 1]);
+		result = lo + (int32_t)(((uint32_t)(hi - lo) * frac) >> 8);
+	}
+
+	//the second half turn is negative
+	return (angle & FX_BAM_180) ? -result : result;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the cosine of an angle.
+ *  @param angle	The angle in binary angle units, any value
+ *  @return cos(angle) in Q15, -FX_ONE_Q15 to FX_ONE_Q15
+ */
+int32_t fx_cos_q15(uint16_t angle)
+{
+	return fx_sin_q15(angle + FX_BAM_90);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the square root of a number, rounded down, one result bit at
+ *	a time.
+ *  @param x	The number to take the square root of
+ *  @return The square root of x
+ */
+uint16_t fx_isqrt(uint32_t x)
+{
+	uint16_t result = 0;
+
+	for (uint16_t bit = 0x8000; bit != 0; bit >>= 1)
+	{
+		uint16_t trial = result | bit;
+		if ((uint32_t)trial * trial <= x)
+		{
+			result = trial;
+		}
+	}
+
+	return result;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function returns the angle whose cosine is c, using acos(c) = atan(s / c)
+ *	with s = sqrt(1 - c^2) so the atan table does the work.
+ *  @param c	The cosine in Q15, clipped to -FX_ONE_Q15 to FX_ONE_Q15
+ *  @return The angle in binary angle units, 0 to FX_BAM_180
+ */
+uint16_t fx_acos_bam(int32_t c)
+{
+	uint32_t ac = (c < 0) ? -c : c;		//size of the cosine
+	uint16_t angle;
+
+	if (ac > (uint32_t)FX_ONE_Q15)
+	{
+		ac = FX_ONE_Q15;
+	}
+
+	//s and c in Q15, so s^2 + c^2 = 2^30
+	angle = fx_atan2_bam(fx_isqrt((1UL << 30) - ac * ac), ac);
+
+	return (c < 0) ? FX_BAM_180 - angle : angle;
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
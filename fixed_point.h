@@ -0,0 +1,39 @@
+//*************************************************************************************
+/** \file fixed_point.h
+ *	Integer math helpers for the motion planner. The ATmega2560 has no floating point
+ *	unit, so anything the planner needs beyond + - * / is done here in fixed point.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _FIXED_POINT_H_
+#define _FIXED_POINT_H_                     ///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+
+/// ln(2) in Q8 format, used to turn log2 results into natural logarithms
+#define FX_LN2_Q8		177
+
+/// Angles are kept in binary angle units, where a full turn is 65536
+#define FX_BAM_90		16384
+#define FX_BAM_180		32768
+
+/// 1.0 in Q15, the format fx_sin_q15() and fx_cos_q15() return
+#define FX_ONE_Q15		32768L
+
+uint16_t fx_log2_q8(uint32_t);					// log2(x) as Q8.8, 0 for x = 0
+int32_t fx_log2_q16(uint32_t);					// log2(x) as Q16.16, 0 for x = 0
+uint32_t fx_scale_pow2(uint32_t, int32_t);		// x * 2^(e / 65536), saturating
+int16_t fx_atan2_bam(int32_t, int32_t);			// atan(y/x) in binary angle units, x > 0
+int32_t fx_sin_q15(uint16_t);					// sin of a binary angle, Q15
+int32_t fx_cos_q15(uint16_t);					// cos of a binary angle, Q15
+uint16_t fx_acos_bam(int32_t);					// acos of a Q15 value in binary angle units
+uint16_t fx_isqrt(uint32_t);					// integer square root, rounded down
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
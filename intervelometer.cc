@@ -17,12 +17,13 @@
 #include "rs232.h"			// Serial Port library
 #include "stl_timer.h"		// Timer library
 #include "stl_task.h"		// Task Timer Library
+#include "menu.h"			// SYNC_ input modes
 #include "intervelometer.h"	//intervelometer motor h file include
+#include "ir_codes.h"		// IR burst tables
 
 
 #define PWM_FREQ OCR5A
 
-
 //-------------------------------------------------------------------------------------
 /** This function reads 16bit values from 16 bit register called PWM_FREQ. Set the
  * 	PWM_FREQ in the pre-processor directive at the beginning of stepper.cc file.
@@ -70,26 +71,198 @@ intervelometer::intervelometer(time_stamp* p_stamp, base_text_serial* p_ser, tas
 	p_time_stamp = p_stamp;			// copy time_stamp pointer
 	p_serial = p_ser;				// copy serial pointer
 	p_timer = p_time;				// copy task timer pointer
+	
+	shutter_speed = 0;
+	pic_delay_ms = 0;
+	motor_delay_ms = 0;
+	focus_lead_ms = 0;
+	focus_release_ms = 0;
+	cam_b_exposure = 0;
+	cam_b_offset = 0;
+	frame_number = 0;
+	ir_remote = IR_OFF;
+	sync_mode = SYNC_OFF;
+	
 	pwm_setup();
 	
 }
 
-void intervelometer::SetTimelapse(unsigned int s_speed)
+//-------------------------------------------------------------------------------------
+/** This method sets the exposure time for the next take_pic().
+ *  @param s_speed	Exposure time in milliseconds
+ */
+void intervelometer::SetTimelapse(unsigned long s_speed)
 {
 	shutter_speed = s_speed;	// copy shutter speed 
 	//pwm_setup(); 				// setup pwm stuff
 }
 
-void intervelometer::SetPicDelay(unsigned int s_speed)
+//-------------------------------------------------------------------------------------
+/** This method sets the length of the next pic delay phase.
+ *  @param ms	Length of the pic delay in milliseconds
+ */
+void intervelometer::SetPicDelay(unsigned int ms)
 {
-	shutter_speed = s_speed;	// copy shutter speed 
-	//pwm_setup(); 				// setup pwm stuff
+	pic_delay_ms = ms;			// copy pic delay
 }
 
-void intervelometer::SetMotorDelay(unsigned int s_speed)
+//-------------------------------------------------------------------------------------
+/** This method sets the length of the next motor delay phase.
+ *  @param ms	Length of the motor delay in milliseconds
+ */
+void intervelometer::SetMotorDelay(unsigned int ms)
 {
-	shutter_speed = s_speed;	// copy shutter speed 
-	//pwm_setup(); 				// setup pwm stuff
+	motor_delay_ms = ms;		// copy motor delay
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets up the focus (half press) line on PL4. Many cameras need it held
+ *	for a while before the shutter to wake up and focus, and a little after.
+ *  @param lead_ms		How long before the shutter the focus line goes high
+ *  @param release_ms	How long after the shutter closes the focus line stays high
+ */
+void intervelometer::SetFocus(unsigned int lead_ms, unsigned int release_ms)
+{
+	focus_lead_ms = lead_ms;
+	focus_release_ms = release_ms;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets up a second camera on PL3, for stereo and dual angle rigs. Its
+ *	shutter is switched by the same Timer 5 tick as the first camera, so the two only
+ *	differ by the offset asked for.
+ *  @param exposure_ms	Second camera's exposure in ms, 0 for no second camera
+ *  @param offset_ms	How long after the first camera the second one opens, in ms
+ */
+void intervelometer::SetCameraB(unsigned long exposure_ms, unsigned int offset_ms)
+{
+	cam_b_exposure = exposure_ms;
+	cam_b_offset = offset_ms;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets the frame number the next picture goes into the frame log under.
+ *  @param frame	Frame number
+ */
+void intervelometer::SetFrame(uint16_t frame)
+{
+	frame_number = frame;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets up the IR remote on OC2A (PB4), for cameras that only take an IR
+ *	trigger. The burst goes out when the first camera's shutter opens: the Timer 5
+ *	ISR starts it, Timer 2 makes the carrier and the Timer 3 compare C interrupt
+ *	switches it on and off at each mark and space, so nothing waits on it. Edges are
+ *	timed from the compare register rather than from when the interrupt ran, so they
+ *	are within a 0.5 us tick of the table.
+ *  @param code	IR_OFF, IR_NIKON, IR_CANON or IR_SONY
+ */
+void intervelometer::SetIrRemote(unsigned char code)
+{
+	const uint16_t* table;
+	uint8_t sreg;
+	
+	//this is called while waiting for input, so leave a burst being sent alone
+	if (code == ir_remote)
+	{
+		return;
+	}
+	ir_remote = code;
+	
+	if (code == IR_NIKON)
+	{
+		table = ir_nikon;
+	}
+	else if (code == IR_CANON)
+	{
+		table = ir_canon;
+	}
+	else if (code == IR_SONY)
+	{
+		table = ir_sony;
+	}
+	else
+	{
+		table = 0;
+	}
+	
+	sreg = SREG;
+	cli();
+	TIMSK3 &= ~(1<<OCIE3C);
+	ir_code = table;
+	SREG = sreg;
+	
+	//LED off between marks: OC2A is only connected to the pin during a mark
+	DDRB |= (1<<DDB4);
+	PORTB &= ~(1<<PORTB4);
+	
+	//CTC, toggle OC2A on compare, no pre-scaler. The clock only runs with a code set
+	TCCR2A = (1<<WGM21);
+	if (table == 0)
+	{
+		TCCR2B = 0;
+	}
+	else
+	{
+		TCCR2B = (1<<CS20);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method sets up the sync input on ICP5 (PL1). It is wired to the camera's flash
+ *	sync or card busy line; an edge during the pic delay ends the delay there, so a
+ *	fast camera doesn't sit out the whole delay. The pic delay is then just a time out.
+ *	PORTL and the Timer 5 registers are shared with the sequencer ISR, so they are
+ *	only written when the mode changes, and then with interrupts off.
+ *  @param mode	SYNC_OFF, SYNC_FALLING or SYNC_RISING
+ */
+void intervelometer::SetSyncInput(unsigned char mode)
+{
+	uint8_t sreg;
+	
+	if (mode == sync_mode)
+	{
+		return;
+	}
+	sync_mode = mode;
+	
+	sreg = SREG;
+	cli();
+	
+	//input with pull-up, for an open collector or a contact to ground
+	DDRL &= ~(1<<DDL1);
+	PORTL |= (1<<PORTL1);
+	
+	//noise canceler on, it only costs 4 clock cycles
+	TCCR5B |= (1<<ICNC5);
+	
+	if (mode == SYNC_RISING)
+	{
+		TCCR5B |= (1<<ICES5);
+	}
+	else
+	{
+		TCCR5B &= ~(1<<ICES5);
+	}
+	
+	//changing the edge can set the flag, so clear it before turning the interrupt on
+	TIFR5 = (1<<ICF5);
+	if (mode == SYNC_OFF)
+	{
+		TIMSK5 &= ~(1<<ICIE5);
+	}
+	else
+	{
+		TIMSK5 |= (1<<ICIE5);
+	}
+	
+	SREG = sreg;
 }
 
 
@@ -99,23 +272,24 @@ void intervelometer::pwm_setup()
 	//disable interrupt while setting up timer.
 	//cli();
 	
-	DDRL |= (1<<DDL5);
-	
-	//set shutter speed to 5 seconds for test
-	//shutter_speed = 5;
-	
-	//start timer, CTC, 256 pre-scalar
-	//TCCR5B |= (1<<CS52) | (1<<WGM52);
+	//shutter on L5, focus on L4, second camera's shutter on L3. L3 is OC5A but OCR5A
+	//  is TOP here, so the ISR drives it as a port pin
+	DDRL |= (1<<DDL5) | (1<<DDL4) | (1<<DDL3);
 	
 	//clear the counter
 	TCNT5 = 0;
 	
-	//set up frequency to 1Hz = 1 second
-	write_16bit(62499);
+	//set up frequency to 1kHz = 1 millisecond (16MHz / 64 / 250). The sequence table
+	//  is counted in milliseconds by the ISR
+	write_16bit(249);
 	
 	//timer/counter 5 interrupt control  
 	TIMSK5 |= (1<<OCIE5C);
 	
+	//start timer, CTC, 64 pre-scalar. It runs from here on as the sequencer time base
+	TCCR5B |= (1<<CS51) | (1<<CS50);
+	TCCR5B |= (1<<WGM52);
+	
 	//enable interrupt for pwm signal
 	//sei();
 
@@ -125,39 +299,202 @@ void intervelometer::pwm_setup()
 
 void intervelometer::stop_timer()
 {
-	//toggle pin LOW
-	PORTL &= ~(1<<PORTL5);
+	uint8_t sreg = SREG;		//save current interrupt flag
+	cli();
+	
+	//toggle pins LOW
+	PORTL &= ~((1<<PORTL5) | (1<<PORTL4) | (1<<PORTL3));
+	
+	//cut off any IR burst
+	TIMSK3 &= ~(1<<OCIE3C);
+	TCCR2A &= ~(1<<COM2A0);
+	
+	//end any sequence, the clock itself keeps running as the time base
+	seq_left = 0;
+	settle_left = 0;
+	inTakePicMode = false;
+	inPicDelayMode = false;
+	inMotorDelayMode = false;
+	focus_release_left = 0;
+	
+	SREG = sreg;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method reads the sequencer time base.
+ *  @return Milliseconds since power up
+ */
+unsigned long intervelometer::time_ms()
+{
+	unsigned long now;
+	uint8_t sreg = SREG;		//save current interrupt flag
 	
-	//turn off timer by setting pre-scalar 0
-	TCCR5B &= ~(1<<CS50) | ~(1<<CS51) | ~(1<<CS52);
+	cli();
+	now = seq_time_ms;
+	SREG = sreg;
 	
-	//reset shutter compare variable
-	shutter_compare = 0;
+	return now;
 }
 
+//-------------------------------------------------------------------------------------
+/** This method fills in one entry of the sequence table. It must only be called with
+ *	interrupts off, since the ISR may be walking the table.
+ *  @param index		Entry to fill in
+ *  @param ticks		How long the entry lasts in ms. A phase of 0 still takes a tick,
+ *						the way the phases always have
+ *  @param pins_set		PORTL bits to set when the entry starts
+ *  @param pins_clear	PORTL bits to clear when the entry starts
+ *  @param type			SEQ_ phase type
+ */
+void intervelometer::set_entry(uint8_t index, unsigned long ticks, uint8_t pins_set, uint8_t pins_clear, uint8_t type)
+{
+	if ((ticks == 0) && (type != SEQ_END))
+	{
+		ticks = 1;
+	}
+	
+	seq_table[index].ticks = ticks;
+	seq_table[index].pins_set = pins_set;
+	seq_table[index].pins_clear = pins_clear;
+	seq_table[index].type = type;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts the ISR on the table just filled in. The first entry starts
+ *	here; the ISR runs the rest. The clock is free running, so the first entry ends
+ *	between N - 1 and N ms from now. Must be called with interrupts off.
+ *  @param focus_hold	Focus release the end entry starts, 0 to leave it alone
+ */
+void intervelometer::start_table(unsigned int focus_hold)
+{
+	PORTL = (PORTL & ~seq_table[0].pins_clear) | seq_table[0].pins_set;
+	
+	seq_focus_hold = focus_hold;
+	seq_index = 0;
+	seq_entry_start = seq_time_ms;
+	seq_left = seq_table[0].ticks;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method takes a picture. The focus line goes high here and the ISR opens the
+ *	shutter on the tick the focus lead is up (the next tick if there is no lead), so
+ *	the exposure itself is always a whole number of ticks. With a second camera its
+ *	edges are merged in time order with the first camera's, and edges that fall on the
+ *	same tick go out in one write to PORTL. The times are copied into the table, so
+ *	settings changed while it runs only count from the next picture.
+ */
 void intervelometer::take_pic()
 {
-	//start timer, CTC, 256 pre-scalar
-	TCCR5B |= (1<<CS52);
-	TCCR5B |= (1<<WGM52);
+	unsigned long at[4];		//time of each shutter edge from now, in ms
+	uint8_t set[4];				//PORTL bits each edge sets
+	uint8_t clear[4];			//PORTL bits each edge clears
+	uint8_t edges = 2;
+	uint8_t focus_off = (focus_release_ms == 0) ? (1<<PORTL4) : 0;
 	
-	//pwm_setup();
+	at[0] = (focus_lead_ms == 0) ? 1 : focus_lead_ms;
+	set[0] = (1<<PORTL5);
+	clear[0] = 0;
+	at[1] = at[0] + ((shutter_speed == 0) ? 1 : shutter_speed);
+	set[1] = 0;
+	clear[1] = (1<<PORTL5);
 	
-	//set L5 to HIGH
-	PORTL |= (1<<PORTL5);
+	if (cam_b_exposure > 0)
+	{
+		at[2] = at[0] + cam_b_offset;
+		set[2] = (1<<PORTL3);
+		clear[2] = 0;
+		at[3] = at[2] + cam_b_exposure;
+		set[3] = 0;
+		clear[3] = (1<<PORTL3);
+		edges = 4;
+	}
 	
-	//clear the counter
-	TCNT5 = 0;
+	//insertion sort, there are at most 4 edges
+	for (uint8_t i = 1; i < edges; i++)
+	{
+		for (uint8_t j = i; (j > 0) && (at[j] < at[j - 1]); j--)
+		{
+			unsigned long t = at[j];
+			at[j] = at[j - 1];
+			at[j - 1] = t;
+			
+			uint8_t b = set[j];
+			set[j] = set[j - 1];
+			set[j - 1] = b;
+			
+			b = clear[j];
+			clear[j] = clear[j - 1];
+			clear[j - 1] = b;
+		}
+	}
+	
+	//edges on the same tick go out together
+	uint8_t groups = 0;
+	for (uint8_t i = 0; i < edges; i++)
+	{
+		if ((groups > 0) && (at[i] == at[groups - 1]))
+		{
+			set[groups - 1] |= set[i];
+			clear[groups - 1] |= clear[i];
+		}
+		else
+		{
+			at[groups] = at[i];
+			set[groups] = set[i];
+			clear[groups] = clear[i];
+			groups++;
+		}
+	}
+	
+	uint8_t sreg = SREG;		//save current interrupt flag
+	cli();
+	
+	//a focus release still running from the last frame ends here
+	focus_release_left = 0;
+	
+	set_entry(0, at[0], (1<<PORTL4), 0, SEQ_FOCUS_LEAD);
+	for (uint8_t g = 0; g < groups - 1; g++)
+	{
+		set_entry(g + 1, at[g + 1] - at[g], set[g], clear[g], SEQ_EXPOSURE);
+	}
+	set_entry(groups, 0, set[groups - 1], clear[groups - 1] | focus_off, SEQ_END);
+	
+	seq_frame = frame_number;
+	start_table(focus_release_ms);
+	inTakePicMode = true;
+	SREG = sreg;
 }
 
+//-------------------------------------------------------------------------------------
+/** This method starts the pic delay phase. The ISR ends the phase after pic_delay_ms
+ *	ticks, or the sync input ends it sooner.
+ */
 void intervelometer::delay_loop()
 {
-	//start timer, CTC, 256 pre-scalar
-	TCCR5B |= (1<<CS52);
-	TCCR5B |= (1<<WGM52);
+	uint8_t sreg = SREG;		//save current interrupt flag
+	cli();
 	
-	//clear the counter
-	TCNT5 = 0;
+	set_entry(0, pic_delay_ms, 0, 0, SEQ_PIC_DELAY);
+	set_entry(1, 0, 0, 0, SEQ_END);
+	
+	start_table(0);
+	inPicDelayMode = true;
+	SREG = sreg;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts the motor delay phase. The ISR ends the phase after
+ *	motor_delay_ms ticks. It has its own count rather than a table entry, so the
+ *	carriage can move and settle while the camera is still in its pic delay.
+ */
+void intervelometer::settle_loop()
+{
+	uint8_t sreg = SREG;		//save current interrupt flag
+	cli();
+	
+	settle_left = (motor_delay_ms == 0) ? 1 : motor_delay_ms;
+	inMotorDelayMode = true;
+	SREG = sreg;
 }
 
 // following line turns on automatic (because I am lazy, or smart, there is a fine line) indentation for Kate editor.
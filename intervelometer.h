@@ -13,9 +13,48 @@
 #ifndef _INTERVELOMETER_H_
 #define _INTERVELOMETER_H_                     	///< Prevents multiple inclusion of file
 
-extern volatile unsigned int shutter_compare; 	// variable for keeping track of shutter timer. 
-extern volatile unsigned int shutter_speed;		//shutter_frequency
+//Phase types in the sequence table
+#define SEQ_END				0		// last entry, the sequence is done
+#define SEQ_FOCUS_LEAD		1		// focus line high, waiting for the camera to wake up
+#define SEQ_EXPOSURE		2		// shutter line high
+#define SEQ_PIC_DELAY		3		// waiting for the camera to save the picture
+
+#define SEQ_TABLE_SIZE		5		// longest sequence is focus lead, 4 shutter edges (2 cameras)
+
+//One entry of the sequence table. The Timer 5 ISR applies the pin action when the
+// entry starts and moves on to the next entry once ticks have gone by.
+typedef struct
+{
+	unsigned long ticks;		// ms the entry lasts, 0 for the end entry
+	uint8_t pins_set;			// PORTL bits to set when the entry starts
+	uint8_t pins_clear;			// PORTL bits to clear when the entry starts
+	uint8_t type;				// SEQ_ phase type
+} seq_entry;
+
+extern volatile seq_entry seq_table[SEQ_TABLE_SIZE];	// sequence the ISR is walking
+extern volatile uint8_t seq_index;				// entry being run
+extern volatile unsigned long seq_left;			// ms left in that entry, 0 when idle
+extern volatile unsigned long seq_entry_start;	// seq_time_ms when that entry started
+extern volatile unsigned int seq_focus_hold;	// focus release to start at the end entry
+extern volatile uint16_t seq_frame;				// frame number for the frame log
+extern volatile unsigned long seq_time_ms;		// ms since power up, Timer 5 never stops
 extern volatile bool inTakePicMode;
+extern volatile bool inPicDelayMode;
+extern volatile bool inMotorDelayMode;
+extern volatile unsigned int focus_release_left;	// ms until the focus line is let go
+extern volatile unsigned int settle_left;		// ms left in the motor delay, runs beside the table
+extern volatile bool sync_captured;				// an edge came in on the sync input
+extern volatile unsigned char sync_phase;		// SYNC_PHASE_ the edge came in during
+extern volatile unsigned long sync_ms;			// ms into that phase the edge came at
+extern volatile uint16_t sync_ticks;			// and 4us ticks past that ms
+
+//IR remote burst, see ir_burst.h
+#include "ir_burst.h"
+
+//Phase a sync input edge came in during, see sync_phase
+#define SYNC_PHASE_IDLE			0
+#define SYNC_PHASE_EXPOSURE		1
+#define SYNC_PHASE_PIC_DELAY	2
 
 class intervelometer
 {
@@ -26,21 +65,41 @@ class intervelometer
         base_text_serial* p_serial;		//Variable to store passed serial port pointer
 		task_timer* p_timer;			//Variable to store passed task_timer
 		
+		unsigned long shutter_speed;	//Length of the next exposure in ms
+		unsigned int pic_delay_ms;		//Length of the next pic delay in ms
+		unsigned int motor_delay_ms;	//Length of the next motor delay in ms
+		unsigned int focus_lead_ms;		//Focus line goes high this long before the shutter
+		unsigned int focus_release_ms;	//Focus line stays high this long after the shutter
+		unsigned long cam_b_exposure;	//Length of the second camera's exposure in ms, 0 for none
+		unsigned int cam_b_offset;		//Second camera opens this long after the first, in ms
+		uint16_t frame_number;			//Frame number the next picture is logged under
+		unsigned char ir_remote;		//IR_ remote code sent with the shutter
+		unsigned char sync_mode;		//SYNC_ input mode the capture unit is set up for
+		
 		void pwm_setup();				//Protected method for setting up pwm timer
 		
 	private:
 		uint16_t read_16bit();			//Private method for read from 16bit register
 		void write_16bit(uint16_t);		//Private method to write to 16bit register
+		void set_entry(uint8_t, unsigned long, uint8_t, uint8_t, uint8_t);	//Private method to fill in a table entry
+		void start_table(unsigned int);	//Private method to start the ISR on a new table
 
 		
      public:
 		intervelometer(time_stamp* , base_text_serial* , task_timer*);
-		void SetTimelapse(unsigned int);
+		void SetTimelapse(unsigned long);
 		void SetPicDelay(unsigned int);
 		void SetMotorDelay(unsigned int);
+		void SetFocus(unsigned int, unsigned int);
+		void SetSyncInput(unsigned char);
+		void SetCameraB(unsigned long, unsigned int);
+		void SetFrame(uint16_t);
+		void SetIrRemote(unsigned char);
+		unsigned long time_ms();
 		void stop_timer();
 		void take_pic();
 		void delay_loop();
+		void settle_loop();
 
 };
 
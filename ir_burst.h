@@ -0,0 +1,102 @@
+//*************************************************************************************
+/** \file ir_burst.h
+ *	Sends the IR remote burst that goes with the shutter. The Timer 5 ISR starts it
+ *	with ir_burst_start() when the first shutter opens, and the Timer 3 compare C ISR
+ *	calls ir_burst_edge() at every mark and space. They are kept out of timescape.cc
+ *	so test/test_ir.cc can run the same code against stand-in registers.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _IR_BURST_H_
+#define _IR_BURST_H_                     	///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+//IR burst tables in flash: the carrier's OCR2A value, how many times to send the
+// burst, then mark and space lengths in us turn about, starting with a mark. A 0
+// ends the table.
+#define IR_CARRIER			0		// index of the carrier's OCR2A value
+#define IR_REPEATS			1		// index of the repeat count
+#define IR_FIRST_ENTRY		2		// index of the first mark
+
+extern const uint16_t* volatile ir_code;		// IR burst table in flash, 0 for none
+extern volatile uint8_t ir_index;				// table entry being sent
+extern volatile uint8_t ir_repeats;				// bursts left to send, this one included
+extern volatile unsigned long ir_left;			// Timer 3 ticks left in that entry
+
+//Starts sending the IR burst, if there is an IR remote. The first mark starts a couple
+// of Timer 3 ticks from now; the compare C interrupt does the rest.
+static inline void ir_burst_start()
+{
+	const uint16_t* code = ir_code;
+	
+	if (code == 0)
+	{
+		return;
+	}
+	
+	OCR2A = pgm_read_word(&code[IR_CARRIER]);
+	ir_repeats = pgm_read_word(&code[IR_REPEATS]);
+	ir_index = IR_FIRST_ENTRY - 1;
+	ir_left = 0;
+	
+	OCR3C = TCNT3 + 4;
+	TIFR3 = (1<<OCF3C);
+	TIMSK3 |= (1<<OCIE3C);
+}
+
+//IR burst edges. Each entry is a mark (carrier on OC2A) or a space (pin low) in turn.
+// Entries longer than the compare register can reach are run in pieces, and every
+// edge is timed from the last compare value, so interrupt latency never adds up.
+static inline void ir_burst_edge()
+{
+	uint16_t us;
+	uint16_t chunk;
+	
+	if (ir_left == 0)
+	{
+		ir_index++;
+		us = pgm_read_word(&ir_code[ir_index]);
+		
+		//end of the burst, send it again or stop
+		if (us == 0)
+		{
+			ir_repeats--;
+			if (ir_repeats == 0)
+			{
+				TIMSK3 &= ~(1<<OCIE3C);
+				TCCR2A &= ~(1<<COM2A0);
+				return;
+			}
+			ir_index = IR_FIRST_ENTRY;
+			us = pgm_read_word(&ir_code[ir_index]);
+		}
+		
+		if (((ir_index - IR_FIRST_ENTRY) & 1) == 0)
+		{
+			TCCR2A |= (1<<COM2A0);
+		}
+		else
+		{
+			TCCR2A &= ~(1<<COM2A0);
+		}
+		
+		//Timer 3 counts 0.5us ticks
+		ir_left = (unsigned long)us * 2;
+	}
+	
+	chunk = (ir_left > 0x8000) ? 0x8000 : ir_left;
+	OCR3C += chunk;
+	ir_left -= chunk;
+}
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
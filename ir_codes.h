@@ -0,0 +1,56 @@
+//*************************************************************************************
+/** \file ir_codes.h
+ *	IR remote burst tables for the cameras SetIrRemote() knows, in the format given in
+ *	ir_burst.h. Only intervelometer.cc (and test/test_ir.cc) may include this, since
+ *	each copy puts the tables in flash again.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _IR_CODES_H_
+#define _IR_CODES_H_                     	///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+//IR burst tables, see IR_CARRIER in ir_burst.h. The carrier is Timer 2
+//  toggling OC2A, 16MHz / (2 * (OCR2A + 1))
+
+/// Nikon ML-L3, 38.5kHz, sent twice
+static const uint16_t ir_nikon[] PROGMEM =
+{
+	207, 2,
+	2000, 27830, 390, 1580, 410, 3580, 400, 63200,
+	0
+};
+
+/// Canon RC-1/RC-6, 32.7kHz. 16 cycles, then the gap that means shoot now
+static const uint16_t ir_canon[] PROGMEM =
+{
+	244, 1,
+	490, 7330, 490,
+	0
+};
+
+/// Sony shutter code 0xB4B8F, 40kHz, sent three times. The 2400us start mark, then
+///  the 20 bits LSB first, 1200us marks for ones and 600us marks for zeros, each
+///  with a 600us space. The last space pads the frame out to 45ms
+static const uint16_t ir_sony[] PROGMEM =
+{
+	199, 3,
+	2400, 600,
+	1200, 600, 1200, 600, 1200, 600, 1200, 600,
+	600, 600, 600, 600, 600, 600, 1200, 600,
+	1200, 600, 1200, 600, 600, 600, 1200, 600,
+	600, 600, 600, 600, 1200, 600, 600, 600,
+	1200, 600, 1200, 600, 600, 600, 1200, 11400,
+	0
+};
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
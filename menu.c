@@ -38,6 +38,8 @@
 #include "lcdmenu1.h"
 
 #include "menu.h"
+#include "ramp.h"
+#include "sun.h"
 
 //def int number of buttons
 #define BUTTON_NUM 5
@@ -73,6 +75,13 @@
 //lcd buffer line
 static char lcdbuff[16];
 
+//lcd column where edited values are written
+#define lcdcursor_POSEDITINIT 0
+
+//eeprom layout version. Bump this whenever menuitem_eet changes so old contents are
+//  replaced by the defaults instead of being read into the wrong fields.
+#define MENUITEM_EEPROM_VERSION 16
+
 //define the eeprom structure
 typedef struct 
 {
@@ -82,10 +91,49 @@ typedef struct
 	unsigned int trackLength;
 	unsigned int pitch;
 	unsigned char teeth;
-	unsigned char shutterSpeed;
-	unsigned char picDelay;
-	unsigned char motorDelay;
+	unsigned long shutterSpeed;
+	unsigned int picDelay;
+	unsigned int motorDelay;
 	unsigned int timelapsePeriod;
+	unsigned int settleMin;
+	unsigned int settleTau;
+	unsigned int rigPeriod;
+	unsigned int settleTol;
+	unsigned char panMode;
+	unsigned int panStepsPerRev;
+	unsigned int panSpeed;
+	unsigned int subjectDist;
+	unsigned int subjectPos;
+	unsigned int resonanceLo[2];
+	unsigned int resonanceHi[2];
+	unsigned int panoHFov;
+	unsigned char panoVFov;
+	unsigned char panoOverlap;
+	unsigned char panoRows;
+	unsigned char panoCols;
+	unsigned int tiltStepsPerRev;
+	unsigned char rampCurve;
+	unsigned long rampEnd;
+	unsigned int rampFirst;
+	unsigned int rampLast;
+	unsigned int focusLead;
+	unsigned int focusHold;
+	unsigned char bracketShots;
+	unsigned char bracketStep;
+	unsigned char syncInput;
+	unsigned long framePeriod;
+	unsigned long camBExposure;
+	unsigned int camBOffset;
+	unsigned char intervalCurve;
+	unsigned long intervalEnd;
+	int sunLat;
+	int sunLon;
+	int utcOffset;
+	unsigned int sunYear;
+	unsigned char sunMonth;
+	unsigned char sunDay;
+	unsigned char irRemote;
+	unsigned char lowPower;
 } menuitem_eet;
 
 menuitem_eet EEMEM menuitem_eemem; //move this to task_menu
@@ -98,16 +146,57 @@ menuitem_eet menuitem_eevar;
 void menuitem_eeprominit() 
 {
 	//Initial values
-	menuitem_eevar.initeeprom = 1;
+	menuitem_eevar.initeeprom = MENUITEM_EEPROM_VERSION;
 	menuitem_eevar.motorRPM = 30;
 	menuitem_eevar.stepsPerRev = 200;
 	menuitem_eevar.trackLength = 1800;
 	menuitem_eevar.pitch = 2032;
 	menuitem_eevar.teeth = 18;
-	menuitem_eevar.shutterSpeed = 20;
-	menuitem_eevar.picDelay = 1;
-	menuitem_eevar.motorDelay = 1;
+	menuitem_eevar.shutterSpeed = 20000;
+	menuitem_eevar.picDelay = 1000;
+	menuitem_eevar.motorDelay = 1000;
 	menuitem_eevar.timelapsePeriod = 300;
+	menuitem_eevar.settleMin = 50;
+	menuitem_eevar.settleTau = 150;
+	menuitem_eevar.rigPeriod = 250;
+	menuitem_eevar.settleTol = 5;
+	menuitem_eevar.panMode = PAN_MODE_OFF;
+	menuitem_eevar.panStepsPerRev = 3200;
+	menuitem_eevar.panSpeed = 400;
+	menuitem_eevar.subjectDist = 2000;
+	menuitem_eevar.subjectPos = 900;
+	menuitem_eevar.resonanceLo[0] = 0;
+	menuitem_eevar.resonanceHi[0] = 0;
+	menuitem_eevar.resonanceLo[1] = 0;
+	menuitem_eevar.resonanceHi[1] = 0;
+	menuitem_eevar.panoHFov = 40;
+	menuitem_eevar.panoVFov = 27;
+	menuitem_eevar.panoOverlap = 30;
+	menuitem_eevar.panoRows = 1;
+	menuitem_eevar.panoCols = 6;
+	menuitem_eevar.tiltStepsPerRev = 3200;
+	menuitem_eevar.rampCurve = RAMP_OFF;
+	menuitem_eevar.rampEnd = 30000;
+	menuitem_eevar.rampFirst = 0;
+	menuitem_eevar.rampLast = 300;
+	menuitem_eevar.focusLead = 0;
+	menuitem_eevar.focusHold = 0;
+	menuitem_eevar.bracketShots = 1;
+	menuitem_eevar.bracketStep = 3;
+	menuitem_eevar.syncInput = SYNC_OFF;
+	menuitem_eevar.framePeriod = 0;
+	menuitem_eevar.camBExposure = 0;
+	menuitem_eevar.camBOffset = 0;
+	menuitem_eevar.intervalCurve = RAMP_OFF;
+	menuitem_eevar.intervalEnd = 20000;
+	menuitem_eevar.sunLat = 0;
+	menuitem_eevar.sunLon = 0;
+	menuitem_eevar.utcOffset = 0;
+	menuitem_eevar.sunYear = 2016;
+	menuitem_eevar.sunMonth = 1;
+	menuitem_eevar.sunDay = 1;
+	menuitem_eevar.irRemote = IR_OFF;
+	menuitem_eevar.lowPower = 0;
 		
 	//Write the initial values to EEPROM
 	eeprom_write_block((const void*)&menuitem_eevar, (void*)&menuitem_eemem, sizeof(menuitem_eet));
@@ -134,6 +223,79 @@ void menuitem_eepromwrite()
 }
 
 
+//-------------------------------------------------------------------------------------
+/*
+ * apply the up/down buttons to a value being edited and write it on the lcd. Holding
+ * a button steps by 10 and then 100 times the base step, like the other menu items.
+ */
+static unsigned long menuitem_editvalue(unsigned long val, unsigned long step, unsigned long min, unsigned long max)
+{
+	unsigned long delta = step;
+
+	if(button_presscount > BUTTON_PRESSCOUNTMAX100)
+		delta = step * 100;
+	else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
+		delta = step * 10;
+
+	//Pressing up button to increase value
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_UP)
+	{
+		val = (max - val < delta) ? max : val + delta;
+	}
+	//Pressing down button will decrease value
+	else if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_DOWN)
+	{
+		val = (val - min < delta) ? min : val - delta;
+	}
+
+	if(val < min)
+		val = min;
+	if(val > max)
+		val = max;
+	ultoa(val, lcdbuff, 10);
+	lcdmenu1_writebuff(lcdbuff);
+	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+
+	return val;
+}
+
+
+//-------------------------------------------------------------------------------------
+/*
+ * same as menuitem_editvalue for values that can go below zero
+ */
+static long menuitem_editsigned(long val, long step, long min, long max)
+{
+	long delta = step;
+
+	if(button_presscount > BUTTON_PRESSCOUNTMAX100)
+		delta = step * 100;
+	else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
+		delta = step * 10;
+
+	//Pressing up button to increase value
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_UP)
+	{
+		val = (max - val < delta) ? max : val + delta;
+	}
+	//Pressing down button will decrease value
+	else if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_DOWN)
+	{
+		val = (val - min < delta) ? min : val - delta;
+	}
+
+	if(val < min)
+		val = min;
+	if(val > max)
+		val = max;
+	ltoa(val, lcdbuff, 10);
+	lcdmenu1_writebuff(lcdbuff);
+	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+
+	return val;
+}
+
+
 //-------------------------------------------------------------------------------------
 /*
  * menu edit functions
@@ -214,7 +376,6 @@ void menuitem_eepromwrite()
 
 
 //----------Menu 1: Preferences---------------
- #define lcdcursor_POSEDITINIT 0
  
 //Motor RPM
 unsigned char motorRPM = 0;
@@ -478,50 +639,122 @@ void menuitem1sub5_exit(void)
 	}
 }
 
-//----------Menu 2: Camera Settings---------------
+//Resonance band 1, bottom and top in steps/s. The slide never cruises between the two;
+//  a top of 0 turns the band off.
+unsigned int res1Lo = 0;
+#define RES1LO_MAX 31250
+#define RES1LO_MIN 0
+void menuitem1sub6_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		res1Lo = menuitem_eevar.resonanceLo[0];
+	}
+	
+	res1Lo = menuitem_editvalue(res1Lo, 1, RES1LO_MIN, RES1LO_MAX);
+}
 
-//Shutter Speed in seconds
-//TODO: figure out how to do fractional seconds without loosing resolution
-unsigned char shutterSpeed = 0;
-#define SHUTTERSPEED_MAX 255  
-#define SHUTTERSPEED_MIN 1
-void menuitem2sub1_enter(void)
+void menuitem1sub6_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.resonanceLo[0] = res1Lo;
+		menuitem_eepromwrite();
+	}
+}
+
+unsigned int res1Hi = 0;
+#define RES1HI_MAX 31250
+#define RES1HI_MIN 0
+void menuitem1sub7_enter(void)
 {
 	//Save variable to eeprom if menu editing is done
 	if(!lcdmenu1_isediting()) 
 	{
 		menuitem_eepromread();
-		shutterSpeed = menuitem_eevar.shutterSpeed;
+		res1Hi = menuitem_eevar.resonanceHi[0];
 	}
 	
-	//Pressing up button to increase value
-	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_UP) 
+	res1Hi = menuitem_editvalue(res1Hi, 1, RES1HI_MIN, RES1HI_MAX);
+}
+
+void menuitem1sub7_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
 	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			shutterSpeed += 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			shutterSpeed += 10;
-		else
-			shutterSpeed++;
-	} 
-	//Pressing down button will decrease value
-	else if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_DOWN) 
+		menuitem_eevar.resonanceHi[0] = res1Hi;
+		menuitem_eepromwrite();
+	}
+}
+
+//Resonance band 2, the same as band 1
+unsigned int res2Lo = 0;
+#define RES2LO_MAX 31250
+#define RES2LO_MIN 0
+void menuitem1sub8_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
 	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			shutterSpeed -= 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			shutterSpeed -= 10;
-		else
-			shutterSpeed--;
+		menuitem_eepromread();
+		res2Lo = menuitem_eevar.resonanceLo[1];
 	}
 	
-	if(shutterSpeed < SHUTTERSPEED_MIN)
-		shutterSpeed = SHUTTERSPEED_MIN;
-	if(shutterSpeed > SHUTTERSPEED_MAX)
-		shutterSpeed = SHUTTERSPEED_MAX;
-	itoa(shutterSpeed, lcdbuff, 10);
-	lcdmenu1_writebuff(lcdbuff);
-	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+	res2Lo = menuitem_editvalue(res2Lo, 1, RES2LO_MIN, RES2LO_MAX);
+}
+
+void menuitem1sub8_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.resonanceLo[1] = res2Lo;
+		menuitem_eepromwrite();
+	}
+}
+
+unsigned int res2Hi = 0;
+#define RES2HI_MAX 31250
+#define RES2HI_MIN 0
+void menuitem1sub9_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		res2Hi = menuitem_eevar.resonanceHi[1];
+	}
+	
+	res2Hi = menuitem_editvalue(res2Hi, 1, RES2HI_MIN, RES2HI_MAX);
+}
+
+void menuitem1sub9_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.resonanceHi[1] = res2Hi;
+		menuitem_eepromwrite();
+	}
+}
+
+//----------Menu 2: Camera Settings---------------
+
+//Shutter Speed in milliseconds. Edited in 10ms steps, which is 1 second a step once the
+//  button has been held for a while, and long enough for bulb exposures of up to an hour.
+unsigned long shutterSpeed = 0;
+#define SHUTTERSPEED_MAX 3600000UL
+#define SHUTTERSPEED_MIN 1
+void menuitem2sub1_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		shutterSpeed = menuitem_eevar.shutterSpeed;
+	}
+	
+	shutterSpeed = menuitem_editvalue(shutterSpeed, 10, SHUTTERSPEED_MIN, SHUTTERSPEED_MAX);
 }
 
 void menuitem2sub1_exit(void)
@@ -533,11 +766,11 @@ void menuitem2sub1_exit(void)
 }
 
 
-//Pic Delay in seconds. This is time to wait after taking a picture. It is basically used so camera 
+//Pic Delay in milliseconds. This is time to wait after taking a picture. It is basically used so camera 
 //  can finish processing. Usually it is 1 seconds per 15 seconds exposure. But can be higher
 //  or lower based on the card read/write speed and camera model. 
-unsigned char picDelay = 0;
-#define PICDELAY_MAX 255  
+unsigned int picDelay = 0;
+#define PICDELAY_MAX 65535  
 #define PICDELAY_MIN 0
 void menuitem2sub2_enter(void)
 {
@@ -548,34 +781,7 @@ void menuitem2sub2_enter(void)
 		picDelay = menuitem_eevar.picDelay;
 	}
 	
-	//Pressing up button to increase value
-	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_UP) 
-	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			picDelay += 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			picDelay += 10;
-		else
-			picDelay++;
-	} 
-	//Pressing down button will decrease value
-	else if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_DOWN) 
-	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			picDelay -= 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			picDelay -= 10;
-		else
-			picDelay--;
-	}
-	
-	if(picDelay < PICDELAY_MIN)
-		picDelay = PICDELAY_MIN;
-	if(picDelay > PICDELAY_MAX)
-		picDelay = PICDELAY_MAX;
-	itoa(picDelay, lcdbuff, 10);
-	lcdmenu1_writebuff(lcdbuff);
-	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+	picDelay = menuitem_editvalue(picDelay, 10, PICDELAY_MIN, PICDELAY_MAX);
 }
 
 void menuitem2sub2_exit(void)
@@ -588,11 +794,11 @@ void menuitem2sub2_exit(void)
 }
 
 
-//Motor Delay in seconds. This is used to add delay before motor starts moving. This is used to 
+//Motor Delay in milliseconds. This is used to add delay before motor starts moving. This is used to 
 //  make sure motor doesn't move before picture is finished taking. 
-unsigned char motorDelay = 0;
-#define PICDELAY_MAX 255  
-#define PICDELAY_MIN 0
+unsigned int motorDelay = 0;
+#define MOTORDELAY_MAX 65535  
+#define MOTORDELAY_MIN 0
 void menuitem2sub3_enter(void)
 {
 	//Save variable to eeprom if menu editing is done
@@ -602,34 +808,7 @@ void menuitem2sub3_enter(void)
 		motorDelay = menuitem_eevar.motorDelay;
 	}
 	
-	//Pressing up button to increase value
-	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_UP) 
-	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			motorDelay += 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			motorDelay += 10;
-		else
-			motorDelay++;
-	} 
-	//Pressing down button will decrease value
-	else if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_DOWN) 
-	{
-		if(button_presscount > BUTTON_PRESSCOUNTMAX100)
-			motorDelay -= 100;
-		else if(button_presscount > BUTTON_PRESSCOUNTMAX10)
-			motorDelay -= 10;
-		else
-			motorDelay--;
-	}
-	
-	if(motorDelay < PICDELAY_MIN)
-		motorDelay = PICDELAY_MIN;
-	if(motorDelay > PICDELAY_MAX)
-		motorDelay = PICDELAY_MAX;
-	itoa(motorDelay, lcdbuff, 10);
-	lcdmenu1_writebuff(lcdbuff);
-	lcd_gotoxy(lcdcursor_POSEDITINIT,1);	
+	motorDelay = menuitem_editvalue(motorDelay, 10, MOTORDELAY_MIN, MOTORDELAY_MAX);
 }
 
 void menuitem2sub3_exit(void)
@@ -693,119 +872,1199 @@ void menuitem2sub4_exit(void)
 	}
 }
 
-
-//----------Menu 3: Initialize---------------
-//Initialize Right 
-//TODO: This function will the system to right end. May need to do this in some other function...
-void menuitem3sub1_enter(void)
+//Settle time constant in milliseconds. This is how fast the rig's wobble dies out after
+//  the carriage stops; the dwell after each move is worked out from it (see task_navigation).
+unsigned int settleTau = 0;
+#define SETTLETAU_MAX 10000
+#define SETTLETAU_MIN 0
+void menuitem2sub5_enter(void)
 {
-	//Check to see if youre editing or pressed enter to go into the menu before initializing..
-	if(lcdmenu1_isediting()) 
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
 	{
-		init_right = 1;
+		menuitem_eepromread();
+		settleTau = menuitem_eevar.settleTau;
 	}
 	
+	settleTau = menuitem_editvalue(settleTau, 1, SETTLETAU_MIN, SETTLETAU_MAX);
 }
 
-void menuitem3sub1_exit(void)
+void menuitem2sub5_exit(void)
 {
-	init_right = 0;
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.settleTau = settleTau;
+		menuitem_eepromwrite();
+	}
 }
 
-//Initialize Left 
-//TODO: This function will the system to left end. May need to do this in some other function...
-void menuitem3sub2_enter(void)
+//Shortest settle dwell in milliseconds, waited after every move however small.
+unsigned int settleMin = 0;
+#define SETTLEMIN_MAX 10000
+#define SETTLEMIN_MIN 0
+void menuitem2sub6_enter(void)
 {
-	//Check to see if youre editing or pressed enter to go into the menu before initializing..
-	if(lcdmenu1_isediting()) 
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
 	{
-		init_left = 1;
+		menuitem_eepromread();
+		settleMin = menuitem_eevar.settleMin;
 	}
 	
+	settleMin = menuitem_editvalue(settleMin, 1, SETTLEMIN_MIN, SETTLEMIN_MAX);
 }
 
-void menuitem3sub2_exit(void)
+void menuitem2sub6_exit(void)
 {
-	init_left = 0;
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.settleMin = settleMin;
+		menuitem_eepromwrite();
+	}
 }
 
-//Start TimeLapse
-void menuitem4_enter(void)
+//Rig's natural period of wobble in milliseconds. Moves shorter than this don't wind
+//  the wobble up fully, so they get a shorter dwell.
+unsigned int rigPeriod = 0;
+#define RIGPERIOD_MAX 10000
+#define RIGPERIOD_MIN 1
+void menuitem2sub7_enter(void)
 {
-	if(lcdmenu1_isediting()) 
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
 	{
-		startTimelapse = 1;
+		menuitem_eepromread();
+		rigPeriod = menuitem_eevar.rigPeriod;
 	}
+	
+	rigPeriod = menuitem_editvalue(rigPeriod, 1, RIGPERIOD_MIN, RIGPERIOD_MAX);
 }
 
-void menuitem4_exit(void)
+void menuitem2sub7_exit(void)
 {
-	startTimelapse = 0;
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.rigPeriod = rigPeriod;
+		menuitem_eepromwrite();
+	}
 }
 
+//Wobble left at the picture, as a carriage speed in steps/s. 0 turns the worked out
+//  dwell off and only Settle Min is waited.
+unsigned int settleTol = 0;
+#define SETTLETOL_MAX 1000
+#define SETTLETOL_MIN 0
+void menuitem2sub8_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		settleTol = menuitem_eevar.settleTol;
+	}
+	
+	settleTol = menuitem_editvalue(settleTol, 1, SETTLETOL_MIN, SETTLETOL_MAX);
+}
 
-
-//-------------------------------------------------------------------------------------
-void menuitem_select(void) 
+void menuitem2sub8_exit(void)
 {
-	micromenu_itemT* curritem = lcdmenu1_curritem();
-	lcd_puts_p((const char*)(curritem->text));
-	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.settleTol = settleTol;
+		menuitem_eepromwrite();
+	}
 }
 
 
-/*
- * built menu
- * 
- * lcdmenu1_makemenu(name, next, prev, parent, sibling, selectfunc, enterfunc, exitfunc, text);
- * @param name is the name of the menuitem
- * @param next is the pointer to next menuitem
- * @param prev is the pointer to the prev menuitem
- * @param parent is the parent of the menuitem
- * @param sibling is the child of the menuitem
- * @param enterfunc is the function to be called when user enter this menuitem
- * @param exitfunc is the function to be called when user exit this menuitem
- * @param text is the text view on lcd for the menuitem
+//----------Menu 5: Pan Axis---------------
 
- */
- 
+//Pan Mode. 0 = pan axis not used, 1 = keep the subject centred while the slide moves,
+//  2 = follow the stars. Sidereal tracking turns against the sky, so the direction
+//  comes from the sign of the latitude under Sun Calc
+unsigned char panMode = 0;
+#define PANMODE_MAX PAN_MODE_SIDEREAL
+#define PANMODE_MIN PAN_MODE_OFF
+void menuitem5sub1_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panMode = menuitem_eevar.panMode;
+	}
+	
+	panMode = menuitem_editvalue(panMode, 1, PANMODE_MIN, PANMODE_MAX);
+}
 
-// lcdmenu1_makemenu(menuitem1, menuitem2, menuitem4, MICROMENU_NULLENTRY, menuitem1sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1"); //sample category
-// lcdmenu1_makemenu(menuitem2, menuitem3, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2_enter, menuitem2_exit, "item (int)"); //sample item
-// lcdmenu1_makemenu(menuitem3, menuitem4, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3_enter, menuitem3_exit, "item (bool)"); //sample item
-// lcdmenu1_makemenu(menuitem4, menuitem1, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu2"); //sample category
-// lcdmenu1_makemenu(menuitem1sub1, menuitem1sub2, menuitem1sub2, menuitem1, menuitem1sub1sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub1"); //sample category
-// lcdmenu1_makemenu(menuitem1sub2, menuitem1sub1, menuitem1sub1, menuitem1, MICROMENU_NULLENTRY, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub2"); //sample category
-// lcdmenu1_makemenu(menuitem1sub1sub1, menuitem1sub1sub1, menuitem1sub1sub1, menuitem1sub1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub1sub1"); //sample category
+void menuitem5sub1_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panMode = panMode;
+		menuitem_eepromwrite();
+	}
+}
 
-//timescape menu builder.
-//Main menu items with submenu
+//Pan steps per revolution of the pan head, including microstepping and gearing
+unsigned int panStepsPerRev = 0;
+#define PANSTEPSPERREV_MAX 65535
+#define PANSTEPSPERREV_MIN 1
+void menuitem5sub2_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panStepsPerRev = menuitem_eevar.panStepsPerRev;
+	}
+	
+	panStepsPerRev = menuitem_editvalue(panStepsPerRev, 1, PANSTEPSPERREV_MIN, PANSTEPSPERREV_MAX);
+}
+
+void menuitem5sub2_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panStepsPerRev = panStepsPerRev;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pan move step rate (steps/s). Tracking moves are short, so they run at this one rate
+unsigned int panSpeed = 0;
+#define PANSPEED_MAX 5000
+#define PANSPEED_MIN 1
+void menuitem5sub5_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panSpeed = menuitem_eevar.panSpeed;
+	}
+	
+	panSpeed = menuitem_editvalue(panSpeed, 1, PANSPEED_MIN, PANSPEED_MAX);
+}
+
+void menuitem5sub5_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panSpeed = panSpeed;
+		menuitem_eepromwrite();
+	}
+}
+
+//Subject distance (mm), measured square out from the track
+unsigned int subjectDist = 0;
+#define SUBJECTDIST_MAX 65535
+#define SUBJECTDIST_MIN 100
+void menuitem5sub3_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		subjectDist = menuitem_eevar.subjectDist;
+	}
+	
+	subjectDist = menuitem_editvalue(subjectDist, 10, SUBJECTDIST_MIN, SUBJECTDIST_MAX);
+}
+
+void menuitem5sub3_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.subjectDist = subjectDist;
+		menuitem_eepromwrite();
+	}
+}
+
+//Subject position (mm) along the track, measured from where the run starts
+unsigned int subjectPos = 0;
+#define SUBJECTPOS_MAX TRACKLENGTH_MAX
+#define SUBJECTPOS_MIN 0
+void menuitem5sub4_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		subjectPos = menuitem_eevar.subjectPos;
+	}
+	
+	subjectPos = menuitem_editvalue(subjectPos, 1, SUBJECTPOS_MIN, SUBJECTPOS_MAX);
+}
+
+void menuitem5sub4_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.subjectPos = subjectPos;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pano field of view across the frame (deg)
+unsigned int panoHFov = 0;
+#define PANOHFOV_MAX 360
+#define PANOHFOV_MIN 1
+void menuitem5sub6_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panoHFov = menuitem_eevar.panoHFov;
+	}
+	
+	panoHFov = menuitem_editvalue(panoHFov, 1, PANOHFOV_MIN, PANOHFOV_MAX);
+}
+
+void menuitem5sub6_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panoHFov = panoHFov;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pano field of view up the frame (deg)
+unsigned char panoVFov = 0;
+#define PANOVFOV_MAX 180
+#define PANOVFOV_MIN 1
+void menuitem5sub7_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panoVFov = menuitem_eevar.panoVFov;
+	}
+	
+	panoVFov = menuitem_editvalue(panoVFov, 1, PANOVFOV_MIN, PANOVFOV_MAX);
+}
+
+void menuitem5sub7_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panoVFov = panoVFov;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pano overlap between neighbouring frames (%)
+unsigned char panoOverlap = 0;
+#define PANOOVERLAP_MAX 90
+#define PANOOVERLAP_MIN 0
+void menuitem5sub8_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panoOverlap = menuitem_eevar.panoOverlap;
+	}
+	
+	panoOverlap = menuitem_editvalue(panoOverlap, 1, PANOOVERLAP_MIN, PANOOVERLAP_MAX);
+}
+
+void menuitem5sub8_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panoOverlap = panoOverlap;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pano rows, moved on the tilt axis
+unsigned char panoRows = 0;
+#define PANOROWS_MAX 50
+#define PANOROWS_MIN 1
+void menuitem5sub9_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panoRows = menuitem_eevar.panoRows;
+	}
+	
+	panoRows = menuitem_editvalue(panoRows, 1, PANOROWS_MIN, PANOROWS_MAX);
+}
+
+void menuitem5sub9_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panoRows = panoRows;
+		menuitem_eepromwrite();
+	}
+}
+
+//Pano columns, moved on the pan axis
+unsigned char panoCols = 0;
+#define PANOCOLS_MAX 100
+#define PANOCOLS_MIN 1
+void menuitem5sub10_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		panoCols = menuitem_eevar.panoCols;
+	}
+	
+	panoCols = menuitem_editvalue(panoCols, 1, PANOCOLS_MIN, PANOCOLS_MAX);
+}
+
+void menuitem5sub10_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.panoCols = panoCols;
+		menuitem_eepromwrite();
+	}
+}
+
+//Tilt steps per revolution of the tilt head. The tilt head runs off the slide
+//  driver, so rows of a pano need the tilt motor plugged in there
+unsigned int tiltStepsPerRev = 0;
+#define TILTSTEPSPERREV_MAX 65535
+#define TILTSTEPSPERREV_MIN 1
+void menuitem5sub11_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		tiltStepsPerRev = menuitem_eevar.tiltStepsPerRev;
+	}
+	
+	tiltStepsPerRev = menuitem_editvalue(tiltStepsPerRev, 1, TILTSTEPSPERREV_MIN, TILTSTEPSPERREV_MAX);
+}
+
+void menuitem5sub11_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.tiltStepsPerRev = tiltStepsPerRev;
+		menuitem_eepromwrite();
+	}
+}
+
+//Start Pano
+void menuitem5sub12_enter(void)
+{
+	if(lcdmenu1_isediting()) 
+	{
+		startPano = 1;
+	}
+}
+
+void menuitem5sub12_exit(void)
+{
+	startPano = 0;
+}
+
+
+//Focus lead in milliseconds. The focus (half press) line goes high this long before the
+//  shutter so the camera can wake up and focus first. 0 turns them on together
+unsigned int focusLead = 0;
+#define FOCUSLEAD_MAX 65535
+#define FOCUSLEAD_MIN 0
+void menuitem2sub9_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		focusLead = menuitem_eevar.focusLead;
+	}
+	
+	focusLead = menuitem_editvalue(focusLead, 10, FOCUSLEAD_MIN, FOCUSLEAD_MAX);
+}
+
+void menuitem2sub9_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.focusLead = focusLead;
+		menuitem_eepromwrite();
+	}
+}
+
+//Focus hold in milliseconds, how long the focus line stays high after the shutter closes
+unsigned int focusHold = 0;
+#define FOCUSHOLD_MAX 65535
+#define FOCUSHOLD_MIN 0
+void menuitem2sub10_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		focusHold = menuitem_eevar.focusHold;
+	}
+	
+	focusHold = menuitem_editvalue(focusHold, 10, FOCUSHOLD_MIN, FOCUSHOLD_MAX);
+}
+
+void menuitem2sub10_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.focusHold = focusHold;
+		menuitem_eepromwrite();
+	}
+}
+
+//HDR bracket, number of exposures at each stop of the carriage. 1 turns bracketing off
+unsigned char bracketShots = 0;
+#define BRACKETSHOTS_MAX 9
+#define BRACKETSHOTS_MIN 1
+void menuitem2sub11_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		bracketShots = menuitem_eevar.bracketShots;
+	}
+	
+	bracketShots = menuitem_editvalue(bracketShots, 1, BRACKETSHOTS_MIN, BRACKETSHOTS_MAX);
+}
+
+void menuitem2sub11_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.bracketShots = bracketShots;
+		menuitem_eepromwrite();
+	}
+}
+
+//HDR bracket step between exposures in 1/3 stops, so 3 is one stop
+unsigned char bracketStep = 0;
+#define BRACKETSTEP_MAX 9
+#define BRACKETSTEP_MIN 1
+void menuitem2sub12_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		bracketStep = menuitem_eevar.bracketStep;
+	}
+	
+	bracketStep = menuitem_editvalue(bracketStep, 1, BRACKETSTEP_MIN, BRACKETSTEP_MAX);
+}
+
+void menuitem2sub12_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.bracketStep = bracketStep;
+		menuitem_eepromwrite();
+	}
+}
+
+//Sync input on PL1, wired to the camera's flash sync or card busy line. 0 = off,
+//  1 = falling edge ends the pic delay, 2 = rising edge ends the pic delay
+unsigned char syncInput = 0;
+#define SYNCINPUT_MAX SYNC_RISING
+#define SYNCINPUT_MIN SYNC_OFF
+void menuitem2sub13_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		syncInput = menuitem_eevar.syncInput;
+	}
+	
+	syncInput = menuitem_editvalue(syncInput, 1, SYNCINPUT_MIN, SYNCINPUT_MAX);
+}
+
+void menuitem2sub13_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.syncInput = syncInput;
+		menuitem_eepromwrite();
+	}
+}
+
+//Fixed frame period in ms. Frames start on a grid this far apart no matter how long
+//  each move takes. 0 = off, frames are spaced by the sum of the phases as before
+unsigned long framePeriod = 0;
+#define FRAMEPERIOD_MAX 3600000UL
+#define FRAMEPERIOD_MIN 0
+void menuitem2sub14_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		framePeriod = menuitem_eevar.framePeriod;
+	}
+	
+	framePeriod = menuitem_editvalue(framePeriod, 10, FRAMEPERIOD_MIN, FRAMEPERIOD_MAX);
+}
+
+void menuitem2sub14_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.framePeriod = framePeriod;
+		menuitem_eepromwrite();
+	}
+}
+
+//Exposure for the second camera on PL3 in ms. 0 = no second camera
+unsigned long camBExposure = 0;
+#define CAMBEXPOSURE_MAX SHUTTERSPEED_MAX
+#define CAMBEXPOSURE_MIN 0
+void menuitem2sub15_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		camBExposure = menuitem_eevar.camBExposure;
+	}
+	
+	camBExposure = menuitem_editvalue(camBExposure, 10, CAMBEXPOSURE_MIN, CAMBEXPOSURE_MAX);
+}
+
+void menuitem2sub15_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.camBExposure = camBExposure;
+		menuitem_eepromwrite();
+	}
+}
+
+//How long after the first camera the second camera's shutter opens, in ms
+unsigned int camBOffset = 0;
+#define CAMBOFFSET_MAX 60000
+#define CAMBOFFSET_MIN 0
+void menuitem2sub16_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		camBOffset = menuitem_eevar.camBOffset;
+	}
+	
+	camBOffset = menuitem_editvalue(camBOffset, 1, CAMBOFFSET_MIN, CAMBOFFSET_MAX);
+}
+
+void menuitem2sub16_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.camBOffset = camBOffset;
+		menuitem_eepromwrite();
+	}
+}
+
+//IR remote code sent when the shutter opens, for cameras with no cable release.
+//  0 = off, 1 = Nikon, 2 = Canon, 3 = Sony. The wired shutter still fires as well
+unsigned char irRemote = 0;
+#define IRREMOTE_MAX IR_SONY
+#define IRREMOTE_MIN IR_OFF
+void menuitem2sub17_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		irRemote = menuitem_eevar.irRemote;
+	}
+	
+	irRemote = menuitem_editvalue(irRemote, 1, IRREMOTE_MIN, IRREMOTE_MAX);
+}
+
+void menuitem2sub17_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.irRemote = irRemote;
+		menuitem_eepromwrite();
+	}
+}
+
+//Low power. 1 = intervelometer only: nothing moves, the ADC and LCD are only on when
+//  needed and the MCU sleeps between Timer 5 ticks, for long runs on a battery
+unsigned char lowPower = 0;
+#define LOWPOWER_MAX 1
+#define LOWPOWER_MIN 0
+void menuitem2sub18_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		lowPower = menuitem_eevar.lowPower;
+	}
+	
+	lowPower = menuitem_editvalue(lowPower, 1, LOWPOWER_MIN, LOWPOWER_MAX);
+}
+
+void menuitem2sub18_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.lowPower = lowPower;
+		menuitem_eepromwrite();
+	}
+}
+
+//----------Menu 6: Ramping---------------
+
+//Ramp curve. 0 = off, 1 = linear, 2 = exponential (same number of stops every frame),
+//  3 = S curve (exponential, easing in and out at the ends)
+unsigned char rampCurve = 0;
+#define RAMPCURVE_MAX RAMP_S
+#define RAMPCURVE_MIN RAMP_OFF
+void menuitem6sub1_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		rampCurve = menuitem_eevar.rampCurve;
+	}
+	
+	rampCurve = menuitem_editvalue(rampCurve, 1, RAMPCURVE_MIN, RAMPCURVE_MAX);
+}
+
+void menuitem6sub1_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.rampCurve = rampCurve;
+		menuitem_eepromwrite();
+	}
+}
+
+//Exposure at the end of the ramp in milliseconds. The start is the Shutter (ms) setting
+unsigned long rampEnd = 0;
+#define RAMPEND_MAX SHUTTERSPEED_MAX
+#define RAMPEND_MIN SHUTTERSPEED_MIN
+void menuitem6sub2_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		rampEnd = menuitem_eevar.rampEnd;
+	}
+	
+	rampEnd = menuitem_editvalue(rampEnd, 10, RAMPEND_MIN, RAMPEND_MAX);
+}
+
+void menuitem6sub2_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.rampEnd = rampEnd;
+		menuitem_eepromwrite();
+	}
+}
+
+//Frame the ramp starts at
+unsigned int rampFirst = 0;
+#define RAMPFIRST_MAX 65535
+#define RAMPFIRST_MIN 0
+void menuitem6sub3_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		rampFirst = menuitem_eevar.rampFirst;
+	}
+	
+	rampFirst = menuitem_editvalue(rampFirst, 1, RAMPFIRST_MIN, RAMPFIRST_MAX);
+}
+
+void menuitem6sub3_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.rampFirst = rampFirst;
+		menuitem_eepromwrite();
+	}
+}
+
+//Frame the ramp ends at
+unsigned int rampLast = 0;
+#define RAMPLAST_MAX 65535
+#define RAMPLAST_MIN 0
+void menuitem6sub4_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		rampLast = menuitem_eevar.rampLast;
+	}
+	
+	rampLast = menuitem_editvalue(rampLast, 1, RAMPLAST_MIN, RAMPLAST_MAX);
+}
+
+void menuitem6sub4_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.rampLast = rampLast;
+		menuitem_eepromwrite();
+	}
+}
+
+//Interval ramp curve, same choices as the exposure ramp. It ramps the frame period
+//  (Camera Settings) to the interval end over the same frames as the exposure ramp
+unsigned char intervalCurve = 0;
+#define INTERVALCURVE_MAX RAMP_S
+#define INTERVALCURVE_MIN RAMP_OFF
+void menuitem6sub5_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		intervalCurve = menuitem_eevar.intervalCurve;
+	}
+	
+	intervalCurve = menuitem_editvalue(intervalCurve, 1, INTERVALCURVE_MIN, INTERVALCURVE_MAX);
+}
+
+void menuitem6sub5_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.intervalCurve = intervalCurve;
+		menuitem_eepromwrite();
+	}
+}
+
+//Frame period at the end of the interval ramp in ms
+unsigned long intervalEnd = 0;
+#define INTERVALEND_MAX FRAMEPERIOD_MAX
+#define INTERVALEND_MIN 10
+void menuitem6sub6_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		intervalEnd = menuitem_eevar.intervalEnd;
+	}
+	
+	intervalEnd = menuitem_editvalue(intervalEnd, 10, INTERVALEND_MIN, INTERVALEND_MAX);
+}
+
+void menuitem6sub6_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.intervalEnd = intervalEnd;
+		menuitem_eepromwrite();
+	}
+}
+
+
+//----------Menu 7: Sun Calc---------------
+//Latitude in hundredths of a degree, north positive
+int sunLat = 0;
+#define SUNLAT_MAX 9000
+#define SUNLAT_MIN -9000
+void menuitem7sub1_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		sunLat = menuitem_eevar.sunLat;
+	}
+	
+	sunLat = menuitem_editsigned(sunLat, 1, SUNLAT_MIN, SUNLAT_MAX);
+}
+
+void menuitem7sub1_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.sunLat = sunLat;
+		menuitem_eepromwrite();
+	}
+}
+
+//Longitude in hundredths of a degree, east positive
+int sunLon = 0;
+#define SUNLON_MAX 18000
+#define SUNLON_MIN -18000
+void menuitem7sub2_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		sunLon = menuitem_eevar.sunLon;
+	}
+	
+	sunLon = menuitem_editsigned(sunLon, 1, SUNLON_MIN, SUNLON_MAX);
+}
+
+void menuitem7sub2_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.sunLon = sunLon;
+		menuitem_eepromwrite();
+	}
+}
+
+//Local time minus UTC in minutes, daylight saving included
+int utcOffset = 0;
+#define UTCOFFSET_MAX 840
+#define UTCOFFSET_MIN -720
+void menuitem7sub3_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		utcOffset = menuitem_eevar.utcOffset;
+	}
+	
+	utcOffset = menuitem_editsigned(utcOffset, 15, UTCOFFSET_MIN, UTCOFFSET_MAX);
+}
+
+void menuitem7sub3_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.utcOffset = utcOffset;
+		menuitem_eepromwrite();
+	}
+}
+
+//Date of the shoot. There is no clock on the board, so it is set here
+unsigned int sunYear = 0;
+#define SUNYEAR_MAX 2099
+#define SUNYEAR_MIN 2000
+void menuitem7sub4_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		sunYear = menuitem_eevar.sunYear;
+	}
+	
+	sunYear = menuitem_editvalue(sunYear, 1, SUNYEAR_MIN, SUNYEAR_MAX);
+}
+
+void menuitem7sub4_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.sunYear = sunYear;
+		menuitem_eepromwrite();
+	}
+}
+
+unsigned char sunMonth = 0;
+#define SUNMONTH_MAX 12
+#define SUNMONTH_MIN 1
+void menuitem7sub5_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		sunMonth = menuitem_eevar.sunMonth;
+	}
+	
+	sunMonth = menuitem_editvalue(sunMonth, 1, SUNMONTH_MIN, SUNMONTH_MAX);
+}
+
+void menuitem7sub5_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.sunMonth = sunMonth;
+		menuitem_eepromwrite();
+	}
+}
+
+unsigned char sunDay = 0;
+#define SUNDAY_MAX 31
+#define SUNDAY_MIN 1
+void menuitem7sub6_enter(void)
+{
+	//Save variable to eeprom if menu editing is done
+	if(!lcdmenu1_isediting()) 
+	{
+		menuitem_eepromread();
+		sunDay = menuitem_eevar.sunDay;
+	}
+	
+	sunDay = menuitem_editvalue(sunDay, 1, SUNDAY_MIN, SUNDAY_MAX);
+}
+
+void menuitem7sub6_exit(void)
+{
+	if(lcdmenu1_buttonpressed == LCDMENU1_BUTTONPRESSED_RIGHT) 
+	{
+		menuitem_eevar.sunDay = sunDay;
+		menuitem_eepromwrite();
+	}
+}
+
+//write a time of day as HH:MM, or --:-- if the sun doesn't get there that day
+static char* menuitem_writetime(char* buff, int16_t minutes)
+{
+	if(minutes == SUN_NONE)
+	{
+		strcpy(buff, "--:--");
+	}
+	else
+	{
+		buff[0] = '0' + (minutes / 60) / 10;
+		buff[1] = '0' + (minutes / 60) % 10;
+		buff[2] = ':';
+		buff[3] = '0' + (minutes % 60) / 10;
+		buff[4] = '0' + (minutes % 60) % 10;
+		buff[5] = '\0';
+	}
+	return buff + 5;
+}
+
+//show two of the day's sun times, local time
+static void menuitem_showsun(unsigned char twilight)
+{
+	sun_times times;
+	char* p;
+
+	sun_calc(GetSunLat(), GetSunLon(), GetUtcOffset(), GetSunYear(), GetSunMonth(), GetSunDay(), &times);
+	p = menuitem_writetime(lcdbuff, twilight ? times.dawn : times.sunrise);
+	*p++ = ' ';
+	menuitem_writetime(p, twilight ? times.dusk : times.sunset);
+	lcdmenu1_writebuff(lcdbuff);
+	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+}
+
+//Sunrise and sunset
+void menuitem7sub7_enter(void)
+{
+	menuitem_showsun(0);
+}
+
+void menuitem7sub7_exit(void)
+{
+}
+
+//Start and end of civil twilight
+void menuitem7sub8_enter(void)
+{
+	menuitem_showsun(1);
+}
+
+void menuitem7sub8_exit(void)
+{
+}
+
+
+//----------Menu 3: Initialize---------------
+//Initialize Right 
+//TODO: This function will the system to right end. May need to do this in some other function...
+void menuitem3sub1_enter(void)
+{
+	//Check to see if youre editing or pressed enter to go into the menu before initializing..
+	if(lcdmenu1_isediting()) 
+	{
+		init_right = 1;
+	}
+	
+}
+
+void menuitem3sub1_exit(void)
+{
+	init_right = 0;
+}
+
+//Initialize Left 
+//TODO: This function will the system to left end. May need to do this in some other function...
+void menuitem3sub2_enter(void)
+{
+	//Check to see if youre editing or pressed enter to go into the menu before initializing..
+	if(lcdmenu1_isediting()) 
+	{
+		init_left = 1;
+	}
+	
+}
+
+void menuitem3sub2_exit(void)
+{
+	init_left = 0;
+}
+
+//Clear E-Stop, only takes effect once the e-stop switch is closed again
+void menuitem3sub3_enter(void)
+{
+	if(lcdmenu1_isediting()) 
+	{
+		estop_clear = 1;
+	}
+	
+}
+
+void menuitem3sub3_exit(void)
+{
+	estop_clear = 0;
+}
+
+//Start TimeLapse
+void menuitem4_enter(void)
+{
+	if(lcdmenu1_isediting()) 
+	{
+		startTimelapse = 1;
+	}
+}
+
+void menuitem4_exit(void)
+{
+	startTimelapse = 0;
+}
+
+
+
+//-------------------------------------------------------------------------------------
+void menuitem_select(void) 
+{
+	micromenu_itemT* curritem = lcdmenu1_curritem();
+	lcd_puts_p((const char*)(curritem->text));
+	lcd_gotoxy(lcdcursor_POSEDITINIT,1);
+}
+
+
+/*
+ * built menu
+ * 
+ * lcdmenu1_makemenu(name, next, prev, parent, sibling, selectfunc, enterfunc, exitfunc, text);
+ * @param name is the name of the menuitem
+ * @param next is the pointer to next menuitem
+ * @param prev is the pointer to the prev menuitem
+ * @param parent is the parent of the menuitem
+ * @param sibling is the child of the menuitem
+ * @param enterfunc is the function to be called when user enter this menuitem
+ * @param exitfunc is the function to be called when user exit this menuitem
+ * @param text is the text view on lcd for the menuitem
+
+ */
+ 
+
+// lcdmenu1_makemenu(menuitem1, menuitem2, menuitem4, MICROMENU_NULLENTRY, menuitem1sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1"); //sample category
+// lcdmenu1_makemenu(menuitem2, menuitem3, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2_enter, menuitem2_exit, "item (int)"); //sample item
+// lcdmenu1_makemenu(menuitem3, menuitem4, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3_enter, menuitem3_exit, "item (bool)"); //sample item
+// lcdmenu1_makemenu(menuitem4, menuitem1, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu2"); //sample category
+// lcdmenu1_makemenu(menuitem1sub1, menuitem1sub2, menuitem1sub2, menuitem1, menuitem1sub1sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub1"); //sample category
+// lcdmenu1_makemenu(menuitem1sub2, menuitem1sub1, menuitem1sub1, menuitem1, MICROMENU_NULLENTRY, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub2"); //sample category
+// lcdmenu1_makemenu(menuitem1sub1sub1, menuitem1sub1sub1, menuitem1sub1sub1, menuitem1sub1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub1sub1"); //sample category
+
+//timescape menu builder.
+//Main menu items with submenu
 lcdmenu1_makemenu(menuitem1, menuitem2, menuitem4, MICROMENU_NULLENTRY, menuitem1sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Preferences");		// Preference menu
-lcdmenu1_makemenu(menuitem2, menuitem3, menuitem1, MICROMENU_NULLENTRY, menuitem2sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Camera Settings"); // Camera Settings Menu
-lcdmenu1_makemenu(menuitem3, menuitem4, menuitem2, MICROMENU_NULLENTRY, menuitem3sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Initialize"); 		//Initialize
+lcdmenu1_makemenu(menuitem2, menuitem6, menuitem1, MICROMENU_NULLENTRY, menuitem2sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Camera Settings"); // Camera Settings Menu
+lcdmenu1_makemenu(menuitem6, menuitem3, menuitem2, MICROMENU_NULLENTRY, menuitem6sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Ramping"); 		//Ramping
+lcdmenu1_makemenu(menuitem3, menuitem5, menuitem6, MICROMENU_NULLENTRY, menuitem3sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Initialize"); 		//Initialize
+lcdmenu1_makemenu(menuitem5, menuitem7, menuitem3, MICROMENU_NULLENTRY, menuitem5sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Pan Axis"); 		//Pan Axis
+lcdmenu1_makemenu(menuitem7, menuitem4, menuitem5, MICROMENU_NULLENTRY, menuitem7sub1, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "Sun Calc"); 		//Sun Calc
 
 //Main menu item with no submenu
-lcdmenu1_makemenu(menuitem4, menuitem1, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, menuitem_select, menuitem4_enter, menuitem4_exit, "Start TL"); //Start TimeLapse
+lcdmenu1_makemenu(menuitem4, menuitem1, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, menuitem_select, menuitem4_enter, menuitem4_exit, "Start TL"); //Start TimeLapse
 
 //Preferences SubMenu
 // lcdmenu1_makemenu(menuitem1sub2, menuitem1sub1, menuitem1sub1, menuitem1, MICROMENU_NULLENTRY, menuitem_select, MICROMENU_NULLFUNC, MICROMENU_NULLFUNC, "menu1sub2"); //sample category
 // lcdmenu1_makemenu(menuitem2, menuitem3, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2_enter, menuitem2_exit, "item (int)"); //sample item
-lcdmenu1_makemenu(menuitem1sub1, menuitem1sub2, menuitem1sub5, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub1_enter, menuitem1sub1_exit, "Motor RPM");		// Preference submenu
+lcdmenu1_makemenu(menuitem1sub1, menuitem1sub2, menuitem1sub9, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub1_enter, menuitem1sub1_exit, "Motor RPM");		// Preference submenu
 lcdmenu1_makemenu(menuitem1sub2, menuitem1sub3, menuitem1sub1, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub2_enter, menuitem1sub2_exit, "Mot. Steps/Rev");	// Preference submenu
 lcdmenu1_makemenu(menuitem1sub3, menuitem1sub4, menuitem1sub2, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub3_enter, menuitem1sub3_exit, "Track (mm)");		// Preference submenu
 lcdmenu1_makemenu(menuitem1sub4, menuitem1sub5, menuitem1sub3, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub4_enter, menuitem1sub4_exit, "Pitch (um)");		// Preference submenu
-lcdmenu1_makemenu(menuitem1sub5, menuitem1sub1, menuitem1sub4, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub5_enter, menuitem1sub5_exit, "Teeth");			// Preference submenu
+lcdmenu1_makemenu(menuitem1sub5, menuitem1sub6, menuitem1sub4, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub5_enter, menuitem1sub5_exit, "Teeth");			// Preference submenu
+lcdmenu1_makemenu(menuitem1sub6, menuitem1sub7, menuitem1sub5, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub6_enter, menuitem1sub6_exit, "Res1 Lo(st/s)");	// Preference submenu
+lcdmenu1_makemenu(menuitem1sub7, menuitem1sub8, menuitem1sub6, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub7_enter, menuitem1sub7_exit, "Res1 Hi(st/s)");	// Preference submenu
+lcdmenu1_makemenu(menuitem1sub8, menuitem1sub9, menuitem1sub7, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub8_enter, menuitem1sub8_exit, "Res2 Lo(st/s)");	// Preference submenu
+lcdmenu1_makemenu(menuitem1sub9, menuitem1sub1, menuitem1sub8, menuitem1, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem1sub9_enter, menuitem1sub9_exit, "Res2 Hi(st/s)");	// Preference submenu
 
 
 //Camera Settings SubMenu
-lcdmenu1_makemenu(menuitem2sub1, menuitem2sub2, menuitem2sub4, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub1_enter, menuitem2sub1_exit, "Shutter (s)");		// Camera Settings submenu
-lcdmenu1_makemenu(menuitem2sub2, menuitem2sub3, menuitem2sub1, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub2_enter, menuitem2sub2_exit, "Pic Delay(s)");	// Camera Settings submenu
-lcdmenu1_makemenu(menuitem2sub3, menuitem2sub4, menuitem2sub2, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub3_enter, menuitem2sub3_exit, "Motor Delay(s)");	// Camera Settings submenu
-lcdmenu1_makemenu(menuitem2sub4, menuitem2sub1, menuitem2sub3, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub4_enter, menuitem2sub4_exit, "Timelapse(min)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub1, menuitem2sub2, menuitem2sub18, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub1_enter, menuitem2sub1_exit, "Shutter (ms)");		// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub2, menuitem2sub3, menuitem2sub1, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub2_enter, menuitem2sub2_exit, "Pic Delay(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub3, menuitem2sub6, menuitem2sub2, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub3_enter, menuitem2sub3_exit, "Mot Delay(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub6, menuitem2sub5, menuitem2sub3, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub6_enter, menuitem2sub6_exit, "Settle Min(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub5, menuitem2sub7, menuitem2sub6, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub5_enter, menuitem2sub5_exit, "Settle Tau(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub7, menuitem2sub8, menuitem2sub5, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub7_enter, menuitem2sub7_exit, "Rig Per.(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub8, menuitem2sub4, menuitem2sub7, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub8_enter, menuitem2sub8_exit, "Settle Tol(st/s)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub4, menuitem2sub9, menuitem2sub8, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub4_enter, menuitem2sub4_exit, "Timelapse(min)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub9, menuitem2sub10, menuitem2sub4, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub9_enter, menuitem2sub9_exit, "Focus Lead(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub10, menuitem2sub11, menuitem2sub9, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub10_enter, menuitem2sub10_exit, "Focus Hold(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub11, menuitem2sub12, menuitem2sub10, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub11_enter, menuitem2sub11_exit, "HDR Shots");		// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub12, menuitem2sub13, menuitem2sub11, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub12_enter, menuitem2sub12_exit, "HDR Step(1/3EV)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub13, menuitem2sub14, menuitem2sub12, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub13_enter, menuitem2sub13_exit, "Sync Input");		// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub14, menuitem2sub15, menuitem2sub13, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub14_enter, menuitem2sub14_exit, "Frame Per.(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub15, menuitem2sub16, menuitem2sub14, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub15_enter, menuitem2sub15_exit, "Cam B Exp(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub16, menuitem2sub17, menuitem2sub15, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub16_enter, menuitem2sub16_exit, "Cam B Offs(ms)");	// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub17, menuitem2sub18, menuitem2sub16, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub17_enter, menuitem2sub17_exit, "IR Remote");		// Camera Settings submenu
+lcdmenu1_makemenu(menuitem2sub18, menuitem2sub1, menuitem2sub17, menuitem2, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem2sub18_enter, menuitem2sub18_exit, "Low Power");		// Camera Settings submenu
+
+//Ramping
+lcdmenu1_makemenu(menuitem6sub1, menuitem6sub2, menuitem6sub6, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub1_enter, menuitem6sub1_exit, "Ramp Curve");		// Ramping submenu
+lcdmenu1_makemenu(menuitem6sub2, menuitem6sub3, menuitem6sub1, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub2_enter, menuitem6sub2_exit, "Ramp End(ms)");	// Ramping submenu
+lcdmenu1_makemenu(menuitem6sub3, menuitem6sub4, menuitem6sub2, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub3_enter, menuitem6sub3_exit, "Ramp From(fr)");	// Ramping submenu
+lcdmenu1_makemenu(menuitem6sub4, menuitem6sub5, menuitem6sub3, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub4_enter, menuitem6sub4_exit, "Ramp To(fr)");		// Ramping submenu
+lcdmenu1_makemenu(menuitem6sub5, menuitem6sub6, menuitem6sub4, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub5_enter, menuitem6sub5_exit, "Int Curve");		// Ramping submenu
+lcdmenu1_makemenu(menuitem6sub6, menuitem6sub1, menuitem6sub5, menuitem6, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem6sub6_enter, menuitem6sub6_exit, "Int End(ms)");	// Ramping submenu
 
 //Initialize
-lcdmenu1_makemenu(menuitem3sub1, menuitem3sub2, menuitem3sub2, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3sub1_enter, menuitem3sub1_exit, "Init Right");	// Initialize submenu
-lcdmenu1_makemenu(menuitem3sub2, menuitem3sub1, menuitem3sub1, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3sub2_enter, menuitem3sub2_exit, "Init Left");	// Initialize submenu
+lcdmenu1_makemenu(menuitem3sub1, menuitem3sub2, menuitem3sub3, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3sub1_enter, menuitem3sub1_exit, "Init Right");	// Initialize submenu
+lcdmenu1_makemenu(menuitem3sub2, menuitem3sub3, menuitem3sub1, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3sub2_enter, menuitem3sub2_exit, "Init Left");	// Initialize submenu
+lcdmenu1_makemenu(menuitem3sub3, menuitem3sub1, menuitem3sub2, menuitem3, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem3sub3_enter, menuitem3sub3_exit, "Clear E-Stop");	// Initialize submenu
+
+//Pan Axis
+lcdmenu1_makemenu(menuitem5sub1, menuitem5sub2, menuitem5sub12, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub1_enter, menuitem5sub1_exit, "Pan Mode");		// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub2, menuitem5sub5, menuitem5sub1, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub2_enter, menuitem5sub2_exit, "Pan Steps/Rev");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub5, menuitem5sub3, menuitem5sub2, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub5_enter, menuitem5sub5_exit, "Pan Speed(st/s)");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub3, menuitem5sub4, menuitem5sub5, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub3_enter, menuitem5sub3_exit, "Subj Dist(mm)");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub4, menuitem5sub6, menuitem5sub3, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub4_enter, menuitem5sub4_exit, "Subj Pos(mm)");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub6, menuitem5sub7, menuitem5sub4, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub6_enter, menuitem5sub6_exit, "Pano HFOV(deg)");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub7, menuitem5sub8, menuitem5sub6, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub7_enter, menuitem5sub7_exit, "Pano VFOV(deg)");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub8, menuitem5sub9, menuitem5sub7, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub8_enter, menuitem5sub8_exit, "Overlap (%)");		// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub9, menuitem5sub10, menuitem5sub8, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub9_enter, menuitem5sub9_exit, "Pano Rows");		// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub10, menuitem5sub11, menuitem5sub9, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub10_enter, menuitem5sub10_exit, "Pano Cols");		// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub11, menuitem5sub12, menuitem5sub10, menuitem5, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem5sub11_enter, menuitem5sub11_exit, "Tilt Steps/Rev");	// Pan Axis submenu
+lcdmenu1_makemenu(menuitem5sub12, menuitem5sub1, menuitem5sub11, menuitem5, MICROMENU_NULLENTRY, menuitem_select, menuitem5sub12_enter, menuitem5sub12_exit, "Start Pano");	// Pan Axis submenu
+
+//Sun Calc SubMenu
+lcdmenu1_makemenu(menuitem7sub1, menuitem7sub2, menuitem7sub8, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub1_enter, menuitem7sub1_exit, "Lat(0.01deg)");		// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub2, menuitem7sub3, menuitem7sub1, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub2_enter, menuitem7sub2_exit, "Lon(0.01deg,E+)");	// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub3, menuitem7sub4, menuitem7sub2, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub3_enter, menuitem7sub3_exit, "UTC Offs(min)");		// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub4, menuitem7sub5, menuitem7sub3, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub4_enter, menuitem7sub4_exit, "Year");			// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub5, menuitem7sub6, menuitem7sub4, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub5_enter, menuitem7sub5_exit, "Month");			// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub6, menuitem7sub7, menuitem7sub5, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub6_enter, menuitem7sub6_exit, "Day");			// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub7, menuitem7sub8, menuitem7sub6, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub7_enter, menuitem7sub7_exit, "Rise/Set");		// Sun Calc submenu
+lcdmenu1_makemenu(menuitem7sub8, menuitem7sub1, menuitem7sub7, menuitem7, MICROMENU_NULLENTRY, MICROMENU_NULLFUNC, menuitem7sub8_enter, menuitem7sub8_exit, "Dawn/Dusk");		// Sun Calc submenu
 
 
 
@@ -814,7 +2073,7 @@ void menuitem_initialize()
 {
 	//init eeprom
 	menuitem_eepromread();
-	if(((int)menuitem_eevar.initeeprom & 0XFF) == 0xFF) { //init values
+	if(menuitem_eevar.initeeprom != MENUITEM_EEPROM_VERSION) { //init values
 		menuitem_eeprominit();
 	}
 
@@ -848,17 +2107,17 @@ unsigned char GetTeeth()
 {
 	return menuitem_eevar.teeth;
 }
-unsigned char GetShutterSpeed()
+unsigned long GetShutterSpeed()
 {
 	return menuitem_eevar.shutterSpeed;
 }
 
-unsigned char GetPicDelay()
+unsigned int GetPicDelay()
 {
 	return menuitem_eevar.picDelay;
 }
 
-unsigned char GetMotorDelay()
+unsigned int GetMotorDelay()
 {
 	return menuitem_eevar.motorDelay;
 }
@@ -868,5 +2127,200 @@ unsigned int GetTimelapsePeriod()
 	return menuitem_eevar.timelapsePeriod;
 }
 
+unsigned int GetSettleMin()
+{
+	return menuitem_eevar.settleMin;
+}
+
+unsigned int GetSettleTau()
+{
+	return menuitem_eevar.settleTau;
+}
+
+unsigned int GetRigPeriod()
+{
+	return menuitem_eevar.rigPeriod;
+}
+
+unsigned int GetSettleTol()
+{
+	return menuitem_eevar.settleTol;
+}
+
+unsigned int GetResonanceLo(unsigned char band)
+{
+	return menuitem_eevar.resonanceLo[band];
+}
+
+unsigned int GetResonanceHi(unsigned char band)
+{
+	return menuitem_eevar.resonanceHi[band];
+}
+
+unsigned char GetPanMode()
+{
+	return menuitem_eevar.panMode;
+}
+
+unsigned int GetPanStepsPerRev()
+{
+	return menuitem_eevar.panStepsPerRev;
+}
+
+unsigned int GetPanSpeed()
+{
+	return menuitem_eevar.panSpeed;
+}
+
+unsigned int GetSubjectDist()
+{
+	return menuitem_eevar.subjectDist;
+}
+
+unsigned int GetSubjectPos()
+{
+	return menuitem_eevar.subjectPos;
+}
+
+unsigned int GetPanoHFov()
+{
+	return menuitem_eevar.panoHFov;
+}
+
+unsigned char GetPanoVFov()
+{
+	return menuitem_eevar.panoVFov;
+}
+
+unsigned char GetPanoOverlap()
+{
+	return menuitem_eevar.panoOverlap;
+}
+
+unsigned char GetPanoRows()
+{
+	return menuitem_eevar.panoRows;
+}
+
+unsigned char GetPanoCols()
+{
+	return menuitem_eevar.panoCols;
+}
+
+unsigned int GetTiltStepsPerRev()
+{
+	return menuitem_eevar.tiltStepsPerRev;
+}
+
+unsigned int GetFocusLead()
+{
+	return menuitem_eevar.focusLead;
+}
+
+unsigned int GetFocusHold()
+{
+	return menuitem_eevar.focusHold;
+}
+
+unsigned char GetBracketShots()
+{
+	return menuitem_eevar.bracketShots;
+}
+
+unsigned char GetBracketStep()
+{
+	return menuitem_eevar.bracketStep;
+}
+
+unsigned char GetSyncInput()
+{
+	return menuitem_eevar.syncInput;
+}
+
+unsigned long GetFramePeriod()
+{
+	return menuitem_eevar.framePeriod;
+}
+
+unsigned long GetCamBExposure()
+{
+	return menuitem_eevar.camBExposure;
+}
+
+unsigned int GetCamBOffset()
+{
+	return menuitem_eevar.camBOffset;
+}
+
+unsigned char GetIrRemote()
+{
+	return menuitem_eevar.irRemote;
+}
+
+unsigned char GetLowPower()
+{
+	return menuitem_eevar.lowPower;
+}
+
+unsigned char GetRampCurve()
+{
+	return menuitem_eevar.rampCurve;
+}
+
+unsigned long GetRampEnd()
+{
+	return menuitem_eevar.rampEnd;
+}
+
+unsigned int GetRampFirst()
+{
+	return menuitem_eevar.rampFirst;
+}
+
+unsigned int GetRampLast()
+{
+	return menuitem_eevar.rampLast;
+}
+
+unsigned char GetIntervalCurve()
+{
+	return menuitem_eevar.intervalCurve;
+}
+
+unsigned long GetIntervalEnd()
+{
+	return menuitem_eevar.intervalEnd;
+}
+
+int GetSunLat()
+{
+	return menuitem_eevar.sunLat;
+}
+
+int GetSunLon()
+{
+	return menuitem_eevar.sunLon;
+}
+
+int GetUtcOffset()
+{
+	return menuitem_eevar.utcOffset;
+}
+
+unsigned int GetSunYear()
+{
+	return menuitem_eevar.sunYear;
+}
+
+unsigned char GetSunMonth()
+{
+	return menuitem_eevar.sunMonth;
+}
+
+unsigned char GetSunDay()
+{
+	return menuitem_eevar.sunDay;
+}
+
 // following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
 // kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
\ No newline at end of file
@@ -22,9 +22,28 @@ extern "C" {
 
 extern volatile int16_t button_presscount;
 
+//Pan axis modes, see GetPanMode()
+#define PAN_MODE_OFF	0		// pan axis not used
+#define PAN_MODE_TRACK	1		// keep the subject centred while the slide moves
+#define PAN_MODE_SIDEREAL	2	// turn at the sidereal rate for the night sky, see pan_stepper::track()
+
+//Sync input modes, see GetSyncInput()
+#define SYNC_OFF		0		// sync input not used, the pic delay always runs in full
+#define SYNC_FALLING	1		// a falling edge ends the pic delay
+#define SYNC_RISING		2		// a rising edge ends the pic delay
+
+//IR remote codes, see GetIrRemote()
+#define IR_OFF			0		// no IR remote, wired shutter only
+#define IR_NIKON		1		// Nikon ML-L3
+#define IR_CANON		2		// Canon RC-1/RC-6, shoots straight away
+#define IR_SONY			3		// Sony RMT-DSLR shutter code
+
 extern volatile unsigned char startTimelapse; 
 extern volatile unsigned char init_left;
 extern volatile unsigned char init_right;
+extern volatile unsigned char estop_clear;
+extern volatile unsigned char startPano;
+extern volatile unsigned char lowPowerRun;
 
 
 extern void menuitem_eeprominit();
@@ -46,6 +65,14 @@ extern void menuitem1sub4_enter();
 extern void menuitem1sub4_exit();
 extern void menuitem1sub5_enter();
 extern void menuitem1sub5_exit();
+extern void menuitem1sub6_enter();
+extern void menuitem1sub6_exit();
+extern void menuitem1sub7_enter();
+extern void menuitem1sub7_exit();
+extern void menuitem1sub8_enter();
+extern void menuitem1sub8_exit();
+extern void menuitem1sub9_enter();
+extern void menuitem1sub9_exit();
 
 extern void menuitem2sub1_enter();
 extern void menuitem2sub1_exit();
@@ -53,11 +80,98 @@ extern void menuitem2sub2_enter();
 extern void menuitem2sub2_exit();
 extern void menuitem2sub3_enter();
 extern void menuitem2sub3_exit();
+extern void menuitem2sub4_enter();
+extern void menuitem2sub4_exit();
+extern void menuitem2sub5_enter();
+extern void menuitem2sub5_exit();
+extern void menuitem2sub6_enter();
+extern void menuitem2sub6_exit();
+extern void menuitem2sub7_enter();
+extern void menuitem2sub7_exit();
+extern void menuitem2sub8_enter();
+extern void menuitem2sub8_exit();
+extern void menuitem2sub9_enter();
+extern void menuitem2sub9_exit();
+extern void menuitem2sub10_enter();
+extern void menuitem2sub10_exit();
+extern void menuitem2sub11_enter();
+extern void menuitem2sub11_exit();
+extern void menuitem2sub12_enter();
+extern void menuitem2sub12_exit();
+extern void menuitem2sub13_enter();
+extern void menuitem2sub13_exit();
+extern void menuitem2sub14_enter();
+extern void menuitem2sub14_exit();
+extern void menuitem2sub15_enter();
+extern void menuitem2sub15_exit();
+extern void menuitem2sub16_enter();
+extern void menuitem2sub16_exit();
+extern void menuitem2sub17_enter();
+extern void menuitem2sub17_exit();
+extern void menuitem2sub18_enter();
+extern void menuitem2sub18_exit();
 
 extern void menuitem3sub1_enter();
 extern void menuitem3sub1_exit();
 extern void menuitem3sub2_enter();
 extern void menuitem3sub2_exit();
+extern void menuitem3sub3_enter();
+extern void menuitem3sub3_exit();
+
+extern void menuitem5sub1_enter();
+extern void menuitem5sub1_exit();
+extern void menuitem5sub2_enter();
+extern void menuitem5sub2_exit();
+extern void menuitem5sub3_enter();
+extern void menuitem5sub3_exit();
+extern void menuitem5sub4_enter();
+extern void menuitem5sub4_exit();
+extern void menuitem5sub5_enter();
+extern void menuitem5sub5_exit();
+extern void menuitem5sub6_enter();
+extern void menuitem5sub6_exit();
+extern void menuitem5sub7_enter();
+extern void menuitem5sub7_exit();
+extern void menuitem5sub8_enter();
+extern void menuitem5sub8_exit();
+extern void menuitem5sub9_enter();
+extern void menuitem5sub9_exit();
+extern void menuitem5sub10_enter();
+extern void menuitem5sub10_exit();
+extern void menuitem5sub11_enter();
+extern void menuitem5sub11_exit();
+extern void menuitem5sub12_enter();
+extern void menuitem5sub12_exit();
+
+extern void menuitem6sub1_enter();
+extern void menuitem6sub1_exit();
+extern void menuitem6sub2_enter();
+extern void menuitem6sub2_exit();
+extern void menuitem6sub3_enter();
+extern void menuitem6sub3_exit();
+extern void menuitem6sub4_enter();
+extern void menuitem6sub4_exit();
+extern void menuitem6sub5_enter();
+extern void menuitem6sub5_exit();
+extern void menuitem6sub6_enter();
+extern void menuitem6sub6_exit();
+
+extern void menuitem7sub1_enter();
+extern void menuitem7sub1_exit();
+extern void menuitem7sub2_enter();
+extern void menuitem7sub2_exit();
+extern void menuitem7sub3_enter();
+extern void menuitem7sub3_exit();
+extern void menuitem7sub4_enter();
+extern void menuitem7sub4_exit();
+extern void menuitem7sub5_enter();
+extern void menuitem7sub5_exit();
+extern void menuitem7sub6_enter();
+extern void menuitem7sub6_exit();
+extern void menuitem7sub7_enter();
+extern void menuitem7sub7_exit();
+extern void menuitem7sub8_enter();
+extern void menuitem7sub8_exit();
 
 extern void menuitem4_enter(void);
 
@@ -70,11 +184,58 @@ extern unsigned int GetTrackLength();
 extern unsigned int GetPitch();
 extern unsigned char GetTeeth();
 
-extern unsigned char GetShutterSpeed();
-extern unsigned char GetPicDelay();
-extern unsigned char GetMotorDelay();
+extern unsigned long GetShutterSpeed();
+extern unsigned int GetPicDelay();
+extern unsigned int GetMotorDelay();
 extern unsigned int GetTimelapsePeriod();
 
+extern unsigned int GetSettleMin();
+extern unsigned int GetSettleTau();
+extern unsigned int GetRigPeriod();
+extern unsigned int GetSettleTol();
+
+extern unsigned int GetResonanceLo(unsigned char);
+extern unsigned int GetResonanceHi(unsigned char);
+
+extern unsigned char GetPanMode();
+extern unsigned int GetPanStepsPerRev();
+extern unsigned int GetPanSpeed();
+extern unsigned int GetSubjectDist();
+extern unsigned int GetSubjectPos();
+
+extern unsigned int GetPanoHFov();
+extern unsigned char GetPanoVFov();
+extern unsigned char GetPanoOverlap();
+extern unsigned char GetPanoRows();
+extern unsigned char GetPanoCols();
+extern unsigned int GetTiltStepsPerRev();
+
+extern unsigned int GetFocusLead();
+extern unsigned int GetFocusHold();
+
+extern unsigned char GetBracketShots();
+extern unsigned char GetBracketStep();
+extern unsigned char GetSyncInput();
+extern unsigned long GetFramePeriod();
+extern unsigned long GetCamBExposure();
+extern unsigned int GetCamBOffset();
+extern unsigned char GetIrRemote();
+extern unsigned char GetLowPower();
+
+extern unsigned char GetRampCurve();
+extern unsigned long GetRampEnd();
+extern unsigned int GetRampFirst();
+extern unsigned int GetRampLast();
+extern unsigned char GetIntervalCurve();
+extern unsigned long GetIntervalEnd();
+
+extern int GetSunLat();
+extern int GetSunLon();
+extern int GetUtcOffset();
+extern unsigned int GetSunYear();
+extern unsigned char GetSunMonth();
+extern unsigned char GetSunDay();
+
 
 #endif
 
@@ -0,0 +1,275 @@
+//*************************************************************************************
+/** \file pan_stepper.cc
+ *	Driver for the second (pan) stepper on two axis rigs. It works like the slide
+ *	stepper in stepper.cc but runs on Timer 1, so both axes can move at the same time.
+ *	Step pulses come out of OC1B (PB6) and the step count is kept by the Timer 1
+ *	overflow interrupt in timescape.cc.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdlib.h>			// Standard C library
+#include <avr/io.h>			// AVR IO library
+#include <avr/interrupt.h>	// Interrupt handling functions
+#include "rs232.h"			// RS232 Library
+#include "stl_timer.h"		// timer library
+#include "pan_stepper.h"	// pan stepper h file include
+#include "estop.h"			// e-stop latch
+
+//Pin assignment for pan stepper pwm and direction
+#define PWM_FREQ     	OCR1A		//variable to change pwm amount of
+
+#define DIR_PIN_DDR		DDRA		//Direction pin data direction register
+#define DIR_BIT			DDA0		//direction bitmask for direction register
+#define DIR_PORT		PORTA		//direction PORT register
+#define DIR_PORT_BIT	PORTA0		//direction port pin
+
+
+//-------------------------------------------------------------------------------------
+/** This function writes the 16bit value to 16bit register called PWM_FREQ. Set the
+ * 	PWM_FREQ in the pre-processor directive at the beginning of pan_stepper.cc file.
+ *  @param var 16bit variables to write to PWM_FREQ register
+ */
+void pan_stepper::write_16bit(uint16_t var)
+{
+	uint8_t sreg;		//8bit variable to store global interrupt flag
+
+	sreg=SREG;			//save current interrupt flag
+	cli();				//disable interrupts
+	PWM_FREQ = var;		//set the 16bit value into register
+	SREG = sreg;		//restore global interrupts flag
+
+}
+
+//-------------------------------------------------------------------------------------
+/** This method sets up PWM related registers, the same way as the slide stepper
+ *  but on Timer 1.
+ */
+void pan_stepper::pwm_setup()
+{
+	//Enable output on Port B, Pin 6 (OC1B)
+	DDRB |= (1<<DDB6);
+
+	//Waveform Generation: Fast PWM, Top set by OCR1A (ie. freq)
+	TCCR1A |= (1<<WGM10) | (1<<WGM11);
+	TCCR1B |= (1<<WGM12) | (1<<WGM13);
+
+	//Compare Output Mode: Clear on compare match - non-inverting
+	TCCR1A |= (1<<COM1B1);
+
+	//Pre-scaler is set by step(); the clock is left off while the axis is idle so
+	//  the overflow interrupt doesn't fire with nothing to count
+
+	TIMSK1 |= (1<<TOIE1);
+
+	//Setup the Output pulse width. Change freq by OCR1A
+	OCR1B = 1;
+
+	//Stop motor. This will control frequency by writing to OCR1A
+	stop();
+
+	*p_serial <<endl <<"Pan PWM setup complete!!";
+}
+
+//Constructor
+//-------------------------------------------------------------------------------------
+/** This is the constructor of pan_stepper class. It sets up the PWM and direction pin.
+ *  @param p_stamp	A pointer to a time_stamp
+ *  @param p_ser	A pointer to a serial port for messages
+ *  @param p_time	A pointer to the task timer
+ */
+pan_stepper::pan_stepper(time_stamp* p_stamp, base_text_serial* p_ser, task_timer* p_time)
+{
+	p_time_stamp = p_stamp;				// copy time_stamp pointer
+	p_serial = p_ser;					// copy serial pointer
+	p_timer = p_time;					// copy task timer pointer
+
+	pwm_setup();						// Setup PWM settings
+
+	//setup the Direction Pin to output
+	DIR_PIN_DDR |= (1<<DIR_BIT);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts a move of a number of steps. The Timer 1 overflow interrupt
+ *	stops the motor when the steps are done and clears inPanMoveMode. Nothing moves
+ *	while an e-stop is latched.
+ *  @param direction		1 for forward, 0 for reverse
+ *  @param steps_to_go		Number of steps to move
+ *  @param at_what_speed	Timer 1 count (TOP) to step at
+ */
+void pan_stepper::step(bool direction, unsigned long steps_to_go, unsigned int at_what_speed)
+{
+	uint8_t sreg;
+	
+	if (steps_to_go == 0)
+	{
+		return;
+	}
+	
+	//the latch check and the start go together, so an e-stop can't come in between
+	//  and have the step pin it disconnected connected again here
+	sreg = SREG;
+	cli();
+	if (!estop_latched)
+	{
+		if (direction)
+		{
+			forward();
+		}
+		else
+		{
+			reverse();
+		}
+
+		pan_steps = steps_to_go;
+		pan_timer_overflow = 0;
+		inPanMoveMode = true;
+		TCCR1A |= (1<<COM1B1);
+		write_16bit(at_what_speed);
+
+		//start the clock, 256 pre-scalar
+		TCNT1 = 0;
+		TCCR1B |= (1<<CS12);
+	}
+	SREG = sreg;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method moves the pan axis to an absolute position.
+ *  @param target			Position to move to, in steps
+ *  @param at_what_speed	Timer 1 count (TOP) to step at
+ */
+void pan_stepper::move_to(long target, unsigned int at_what_speed)
+{
+	long distance = target - pan_position;
+
+	if (distance >= 0)
+	{
+		step(1, distance, at_what_speed);
+	}
+	else
+	{
+		step(0, -distance, at_what_speed);
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** This method turns the pan axis once per sidereal day until stop() is called, for
+ *	following the stars. One step is a whole number of Timer 1 ticks and a Q32
+ *	fraction; the Timer 1 overflow interrupt adds the fraction up and puts in the
+ *	extra tick whenever it carries, so the rate is right to 2^-32 of a tick and the
+ *	crystal is the only long-term error (50 ppm is under a step an hour on a typical
+ *	head). Steps longer than the 65536 tick timer are split into equal periods and
+ *	only the last one lets its pulse out. Nothing moves while an e-stop is latched.
+ *  @param direction		1 for forward, 0 for reverse
+ *  @param steps_per_rev	Steps per turn of the pan axis, gearing included
+ */
+void pan_stepper::track(bool direction, unsigned long steps_per_rev)
+{
+	unsigned long period;		//ticks per step, whole part
+	unsigned long div;			//timer periods per step
+	unsigned long rem;			//ticks per timer period, remainder
+	uint8_t sreg;
+
+	if ((steps_per_rev == 0) || estop_latched)
+	{
+		return;
+	}
+
+	stop();
+
+	if (direction)
+	{
+		forward();
+	}
+	else
+	{
+		reverse();
+	}
+
+	period = SIDEREAL_DAY_TICKS / steps_per_rev;
+	div = (period > 65536UL) ? (period / 65536UL) + 1 : 1;
+	period = SIDEREAL_DAY_TICKS / (steps_per_rev * div);
+	rem = SIDEREAL_DAY_TICKS % (steps_per_rev * div);
+
+	sreg = SREG;
+	cli();
+	if (estop_latched)
+	{
+		SREG = sreg;
+		return;
+	}
+	pan_track_top = period - 1;
+	pan_track_frac = (uint32_t)(((uint64_t)rem << 32) / (steps_per_rev * div));
+	pan_track_acc = 0;
+	pan_track_div = div;
+	pan_track_sub = div - 1;
+	pan_tracking = true;
+
+	//the first period steps if there is only one period per step
+	if (div == 1)
+	{
+		TCCR1A |= (1<<COM1B1);
+	}
+	else
+	{
+		TCCR1A &= ~(1<<COM1B1);
+	}
+	write_16bit(period - 1);
+
+	//start the clock, 1024 pre-scalar
+	TCNT1 = 0;
+	TCCR1B |= (1<<CS12) | (1<<CS10);
+	SREG = sreg;
+
+	*p_serial <<endl <<"Sidereal tracking, " <<div <<" x " <<period <<" ticks + " <<pan_track_frac <<"/2^32 per step";
+}
+
+//-------------------------------------------------------------------------------------
+/** This method tells the driver where the axis is now without moving it.
+ *  @param position	The current position in steps
+ */
+void pan_stepper::set_position(long position)
+{
+	uint8_t sreg = SREG;		//save current interrupt flag
+	cli();
+	pan_position = position;
+	SREG = sreg;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method sets the pan motor to turn in the forward direction
+ */
+void pan_stepper::forward()
+{
+	DIR_PORT |= (1<<DIR_PORT_BIT);	//write 1 to DIR_PORT connected to DIR pin on easydriver
+	pan_direction = 1;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method sets the pan motor to turn in the reverse direction
+ */
+void pan_stepper::reverse()
+{
+	DIR_PORT &= ~(1<<DIR_PORT_BIT);	//write 0 to DIR_PORT connected to DIR pin on easydriver
+	pan_direction = -1;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method stops the pan motor
+ */
+void pan_stepper::stop()
+{
+	//turn off timer by setting pre-scalar 0
+	TCCR1B &= ~((1<<CS10) | (1<<CS11) | (1<<CS12));
+	write_16bit(0);
+	inPanMoveMode = false;
+	pan_tracking = false;
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,64 @@
+//*************************************************************************************
+/** \file pan_stepper.h
+ *	Driver for the second (pan) stepper on two axis rigs. It works like the slide
+ *	stepper in stepper.h but runs on Timer 1, so both axes can move at the same time.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _PAN_STEPPER_H_
+#define _PAN_STEPPER_H_                 ///< Prevents multiple inclusion of file
+
+
+extern volatile unsigned long pan_timer_overflow;	//steps taken in the current pan move
+extern volatile unsigned long pan_steps;			//steps to take in the current pan move
+extern volatile signed char pan_direction;			//+1 or -1, added to pan_position each step
+extern volatile long pan_position;					//pan position in steps
+extern volatile bool inPanMoveMode;					//true while a pan move is running
+extern volatile bool pan_tracking;					//true while the axis is tracking the sky
+extern volatile uint16_t pan_track_top;				//whole Timer 1 ticks per tracking period, less one
+extern volatile uint32_t pan_track_frac;			//fraction of a tick per tracking period, Q32
+extern volatile uint32_t pan_track_acc;				//fractions of a tick built up so far, Q32
+extern volatile uint16_t pan_track_div;				//tracking periods per step
+extern volatile uint16_t pan_track_sub;				//tracking periods left before the one that steps
+
+/// Length of a sidereal day (86164.0905 s) in 64 us Timer 1 ticks (1024 pre-scalar)
+#define SIDEREAL_DAY_TICKS	1346313914UL
+
+/// Slowest and fastest pan move step rates in steps/s. Moves run Timer 1 at 62.5kHz
+/// (256 pre-scalar), so the slowest is the one whose TOP still fits in 16 bits
+#define PAN_SPEED_MIN		1
+#define PAN_SPEED_MAX		5000
+
+class pan_stepper
+{
+
+     protected:
+		time_stamp* p_time_stamp;		//Variable to store passed time_stamp pointer
+        base_text_serial* p_serial;		//Variable to store passed serial port pointer
+		task_timer* p_timer;			//Variable to store passed task_timer
+		void pwm_setup();				//Protected method for setting up pwm timer
+
+	private:
+		void write_16bit(uint16_t);		//Private method to write to 16bit register
+
+     public:
+        pan_stepper(time_stamp*, base_text_serial*, task_timer*);	//Constructor
+		void step(bool, unsigned long, unsigned int);	//Method for moving a number of steps
+		void move_to(long, unsigned int);				//Method for moving to an absolute position
+		void track(bool, unsigned long);				//Method for turning at the sidereal rate
+		void set_position(long);						//Method for setting where the axis is now
+		void forward();									//Method for setting forward direction
+		void reverse();									//Method for setting reverse direction
+		void stop();									//Method for stopping motor
+
+};
+
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,112 @@
+//*************************************************************************************
+/** \file ramp.cc
+ *	A value that changes gradually over a range of frames, such as the exposure time
+ *	getting longer as the sun goes down. Everything is integer math from
+ *	fixed_point.cc, so working out a frame's value costs a few multiplies.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdlib.h>			// Standard C library
+#include "fixed_point.h"	// Integer math helpers
+#include "ramp.h"			// ramp h file include
+
+
+//Constructor
+//-------------------------------------------------------------------------------------
+/** This is the constructor of the ramp class. The ramp starts off as RAMP_OFF with a
+ *	value of 0 until set() is called.
+ */
+ramp::ramp()
+{
+	set(0, 0, RAMP_OFF, 0, 0);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method sets up the ramp.
+ *  @param start	Value up to and including the first frame
+ *  @param end		Value from the last frame on
+ *  @param curve_t	Shape of the ramp, one of the RAMP_ curves
+ *  @param first	First frame of the ramp
+ *  @param last		Last frame of the ramp
+ */
+void ramp::set(unsigned long start, unsigned long end, unsigned char curve_t, unsigned int first, unsigned int last)
+{
+	start_value = start;
+	end_value = end;
+	curve = curve_t;
+	first_frame = first;
+	last_frame = last;
+
+	if (last_frame < first_frame)
+	{
+		last_frame = first_frame;
+	}
+
+	//the exponential curves can't start or end at 0, so treat 0 as 1
+	log2_ratio = fx_log2_q16(end ? end : 1) - fx_log2_q16(start ? start : 1);
+}
+
+//-------------------------------------------------------------------------------------
+/** This method works out the value at a frame.
+ *  @param frame	Frame number
+ *  @return The value at that frame
+ */
+unsigned long ramp::value(unsigned int frame)
+{
+	uint16_t t;				//position along the ramp, Q12
+	unsigned long span;		//size of the change for RAMP_LINEAR
+
+	if ((curve == RAMP_OFF) || (frame <= first_frame))
+	{
+		return start_value;
+	}
+
+	if (frame >= last_frame)
+	{
+		return end_value;
+	}
+
+	t = (uint16_t)(((unsigned long)(frame - first_frame) << 12) / (last_frame - first_frame));
+
+	switch (curve)
+	{
+		case (RAMP_LINEAR):
+			if (end_value >= start_value)
+			{
+				span = end_value - start_value;
+				return start_value + (span >> 12) * t + (((span & 0x0FFF) * t) >> 12);
+			}
+			span = start_value - end_value;
+			return start_value - (span >> 12) * t - (((span & 0x0FFF) * t) >> 12);
+
+		case (RAMP_S):
+			//smoothstep, 3t^2 - 2t^3, then on to the exponential curve
+			t = (uint16_t)(((((unsigned long)t * t) >> 12) * (3UL * 4096 - 2UL * t)) >> 12);
+			//no break
+
+		default:
+			//split the multiply so log2_ratio * t can't overflow
+			return fx_scale_pow2(start_value ? start_value : 1, (log2_ratio >> 12) * t + (((log2_ratio & 0x0FFF) * t) >> 12));
+	};
+}
+
+//-------------------------------------------------------------------------------------
+/** This method tells where the value stops changing.
+ *  @return The last frame of the ramp, or 0 if the ramp is off
+ */
+unsigned int ramp::end_frame()
+{
+	if (curve == RAMP_OFF)
+	{
+		return 0;
+	}
+
+	return last_frame;
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,47 @@
+//*************************************************************************************
+/** \file ramp.h
+ *	A value that changes gradually over a range of frames, such as the exposure time
+ *	getting longer as the sun goes down. Before the first frame of the range the value
+ *	is the start value and after the last frame it is the end value.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _RAMP_H_
+#define _RAMP_H_                     	///< Prevents multiple inclusion of file
+
+//Ramp curves. These are menu settings as well, so menu.c includes this file
+#define RAMP_OFF		0		// no ramp, the value stays at the start value
+#define RAMP_LINEAR		1		// straight line from start to end
+#define RAMP_EXP		2		// the same ratio (stops of exposure) every frame
+#define RAMP_S			3		// like RAMP_EXP but easing in and out at the ends
+
+#ifdef __cplusplus
+
+class ramp
+{
+	protected:
+		unsigned long start_value;		//value up to the first frame
+		unsigned long end_value;		//value from the last frame on
+		unsigned char curve;			//one of the RAMP_ curves
+		unsigned int first_frame;		//first frame of the ramp
+		unsigned int last_frame;		//last frame of the ramp
+		int32_t log2_ratio;				//log2(end / start) in Q16.16
+
+	public:
+		ramp();
+		void set(unsigned long, unsigned long, unsigned char, unsigned int, unsigned int);
+		unsigned long value(unsigned int);			//value at a frame
+		unsigned int end_frame();					//frame the value stops changing at
+
+};
+
+#endif
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -18,6 +18,7 @@
 #include "stl_timer.h"		// timer library
 #include "stl_task.h"		// task library  -- dont think you need this here..
 #include "stepper.h"		//stepper motor h file include
+#include "estop.h"			//e-stop latch
 
 //Pin assignment for stepper motor pwm and direction
 #define PWM_FREQ     	OCR4A		//variable to change pwm amount of
@@ -213,6 +214,13 @@ stepper::stepper(time_stamp* p_stamp, base_text_serial* p_ser, task_timer* p_tim
 	steps_per_rev = number_of_steps;	// copy variable number of steps
 	step_delay = 70;					// set stepping delay to 70us
 	
+	//no resonance bands until set_resonance_band() is called
+	for (unsigned char band = 0; band < STEPPER_RES_BANDS; band++)
+	{
+		band_lo[band] = 0;
+		band_hi[band] = 0;
+	}
+	
 	pwm_setup();						// Setup PWM settings
 	
 	//setup the Direction Pin to output
@@ -229,30 +237,158 @@ stepper::stepper(time_stamp* p_stamp, base_text_serial* p_ser, task_timer* p_tim
 }
 
 //-------------------------------------------------------------------------------------
-/** 
- *  @param 
- *  @return
+/** This method sets a band of step rates where the motor and belt resonate and lose
+ *	steps. Moves started with step() never cruise inside a band. A band with a top of
+ *	0 is turned off.
+ *  @param band		Which band to set, 0 to STEPPER_RES_BANDS - 1
+ *  @param lo_rate	Bottom of the band in steps/s
+ *  @param hi_rate	Top of the band in steps/s
  */
-void stepper::step(bool direction, unsigned long steps_to_go, unsigned int at_what_speed)
+void stepper::set_resonance_band(unsigned char band, unsigned int lo_rate, unsigned int hi_rate)
+{
+	if (band < STEPPER_RES_BANDS)
+	{
+		band_lo[band] = lo_rate;
+		band_hi[band] = hi_rate;
+	}
+}
+
+//-------------------------------------------------------------------------------------
+/** This method moves a Timer 4 count out of the resonance bands. A speed inside a band
+ *	is nudged to whichever edge of the band is closer, going faster on a tie so runs
+ *	don't get slower than they have to. The step generator has no acceleration ramp, so
+ *	a move jumps straight to its cruise speed and never spends any time at the slower
+ *	rates it skips over; keeping the cruise speed clear is all that's needed.
+ *  @param timer_count	Timer 4 count (TOP) the move wants to run at
+ *  @return A timer count whose step rate is outside all the bands
+ */
+unsigned int stepper::avoid_resonance(unsigned int timer_count)
 {
+	unsigned long count = timer_count;	//count being nudged
+	unsigned long rate;				//whole steps/s at count, for picking the closer edge
+	unsigned char inside;			//band the count's real rate is in, STEPPER_RES_BANDS for none
+	bool slower = false;			//true once a nudge has gone below a band
+	bool faster = false;			//true once a nudge has gone above a band
 	
-	steps = steps_to_go;
+	if (timer_count == 0)
+	{
+		return timer_count;
+	}
 	
-	if (direction)
+	//the real rate is (CPU_FREQ_Hz/PRESCALER)/(count+1) with a fraction, so the band
+	//  checks multiply out instead of dividing. Nudging out of one band can land in
+	//  another, so go round until the count is clear of them all, carrying on the way
+	//  the first nudge went so bands which touch can't bounce it back and forth
+	for (unsigned char pass = 0; pass <= STEPPER_RES_BANDS; pass++)
 	{
-		forward();
-		timer_overflow = 0;
-		set_speed(at_what_speed);
+		inside = STEPPER_RES_BANDS;
+		for (unsigned char band = 0; band < STEPPER_RES_BANDS; band++)
+		{
+			if ((band_hi[band] == 0) || (band_lo[band] > band_hi[band]))
+			{
+				continue;
+			}
+			
+			if (((unsigned long)band_lo[band] * (count + 1) <= (CPU_FREQ_Hz / PRESCALER))
+				&& ((CPU_FREQ_Hz / PRESCALER) <= (unsigned long)band_hi[band] * (count + 1)))
+			{
+				inside = band;
+				break;
+			}
+		}
+		
+		if (inside == STEPPER_RES_BANDS)
+		{
+			return (unsigned int)count;
+		}
+		
+		rate = (CPU_FREQ_Hz / PRESCALER) / (count + 1);
+		if (!faster && !slower)
+		{
+			slower = ((rate - band_lo[inside]) < (band_hi[inside] - rate));
+			faster = !slower;
+		}
+		if (slower && (band_lo[inside] > 1))
+		{
+			//smallest count + 1 which is more than (CPU_FREQ_Hz/PRESCALER)/band_lo
+			count = (CPU_FREQ_Hz / PRESCALER) / band_lo[inside];
+		}
+		else
+		{
+			//largest count + 1 which is less than (CPU_FREQ_Hz/PRESCALER)/band_hi
+			count = ((CPU_FREQ_Hz / PRESCALER) - 1) / band_hi[inside];
+			
+			//can't step faster than a count of 1
+			count = (count > 2) ? count - 1 : 1;
+		}
 	}
 	
-	else
+	return (unsigned int)count;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts a move. The speed is moved out of any resonance bands first.
+ *	Nothing moves while an e-stop is latched.
+ *  @param direction		1 for forward, 0 for reverse
+ *  @param steps_to_go		Number of steps to move
+ *  @param at_what_speed	Timer 4 count (TOP) to step at
+ */
+void stepper::step(bool direction, unsigned long steps_to_go, unsigned int at_what_speed)
+{
+	step_exact(direction, steps_to_go, avoid_resonance(at_what_speed));
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts a move at just the speed given, leaving the resonance bands
+ *	out. The bands are the slide's, so the pano's tilt motor, which runs from this
+ *	output, steps through here. The e-stop latch is checked and the move started with
+ *	interrupts off, so an e-stop can't come in between and have its outputs turned
+ *	back on here; nothing moves while it is latched. The step outputs the e-stop ISR
+ *	disconnected are connected to the timer again.
+ *  @param direction		1 for forward, 0 for reverse
+ *  @param steps_to_go		Number of steps to move
+ *  @param at_what_speed	Timer 4 count (TOP) to step at
+ */
+void stepper::step_exact(bool direction, unsigned long steps_to_go, unsigned int at_what_speed)
+{
+	uint8_t sreg;
+	
+	sreg = SREG;
+	cli();
+	if (!estop_latched)
 	{
-		reverse();
+		if (direction)
+		{
+			forward();
+		}
+		else
+		{
+			reverse();
+		}
+		
+		steps = steps_to_go;
 		timer_overflow = 0;
+		TCCR4A |= (1<<COM4A1) | (1<<COM4B1);
 		set_speed(at_what_speed);
 	}
+	SREG = sreg;
+}
+
+//-------------------------------------------------------------------------------------
+/** This method reads the step count the Timer 4 ISR keeps. Any motor on this output
+ *	moves it, so the pano's tilt motor counts here too.
+ *  @return The position in steps
+ */
+long stepper::get_position()
+{
+	uint8_t sreg;
+	long position;
 	
-	
+	sreg = SREG;
+	cli();
+	position = slide_position;
+	SREG = sreg;
+	return position;
 }
 
 
@@ -286,6 +422,7 @@ void stepper::set_speed(uint16_t sp)
 void stepper::forward()
 {
 	DIR_PORT |= (1<<DIR_PORT_BIT);	//write 1 to DIR_PORT connected to DIR pin on easydriver
+	slide_direction = 1;
 }
 
 
@@ -297,6 +434,7 @@ void stepper::forward()
 void stepper::reverse()
 {
 	DIR_PORT &= ~(1<<DIR_PORT_BIT);	//write 0 to DIR_PORT connected to DIR pin on easydriver
+	slide_direction = -1;
 }
 
 
@@ -310,6 +448,26 @@ void stepper::stop()
 	pwm_off();
 }
 
+//-------------------------------------------------------------------------------------
+/** This method stops the motor and the Timer 4 clock. A stopped motor still has the
+ *	timer overflowing at TOP = 0, which would wake the MCU every 16us, so low power
+ *	runs turn the clock off until clock_on().
+ */
+void stepper::clock_off()
+{
+	stop();
+	TCCR4B &= ~((1<<CS40) | (1<<CS41) | (1<<CS42));
+}
+
+//-------------------------------------------------------------------------------------
+/** This method starts the Timer 4 clock again after clock_off(), 256 pre-scalar as
+ *	set up in pwm_setup().
+ */
+void stepper::clock_on()
+{
+	TCCR4B |= (1<<CS42);
+}
+
 
 //-------------------------------------------------------------------------------------
 /** This method initializes motor to left
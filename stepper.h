@@ -16,6 +16,10 @@
 
 extern volatile unsigned long timer_overflow;		//global variable declared in main()
 extern volatile unsigned long steps;
+extern volatile long slide_position;				//slide position in steps
+extern volatile signed char slide_direction;		//+1 or -1, added to slide_position each step
+
+#define STEPPER_RES_BANDS	2			///< Number of resonance bands the planner steers around
 
 class stepper
 {
@@ -28,6 +32,8 @@ class stepper
 		bool pwm_set;					//Variable to store pwm_set
 		unsigned int steps_per_rev;		//Variable to store steps_per_rev
 		unsigned int step_delay;		//Variable to store step_delay
+		unsigned int band_lo[STEPPER_RES_BANDS];	//Bottom of each resonance band in steps/s
+		unsigned int band_hi[STEPPER_RES_BANDS];	//Top of each resonance band in steps/s
 		void pwm_setup();				//Protected method for setting up pwm timer
 		
 		
@@ -41,11 +47,17 @@ class stepper
         void step_mode(unsigned char);					//setting up stepping mode (i.e.. full, half, quarter, eighth stepping mode)
         void pwm_off();									//Method for turning off PWM
 		void step(bool, unsigned long, unsigned int);	//Method for incrementing certain number of steps
+		void step_exact(bool, unsigned long, unsigned int);	//Method for stepping at a speed the resonance bands don't move
+		long get_position();							//Method for reading the step count
         void set_speed(uint16_t);						//Method for setting speed of the motor (i.e.. Frequency)
 		void forward();									//Method for setting forward direction
 		void reverse();									//Method for setting reverse direction
 		void stop();									//Method for stopping motor
+		void clock_off();								//Method for stopping the step timer altogether
+		void clock_on();								//Method for starting the step timer again
 		void initialize();								//Method for Initializing carriage to left
+		void set_resonance_band(unsigned char, unsigned int, unsigned int);	//Method for setting a band of step rates to stay out of
+		unsigned int avoid_resonance(unsigned int);		//Method for moving a timer count out of the resonance bands
 
 };
 
@@ -0,0 +1,271 @@
+//======================================================================================
+/** \file stl_scheduler.cc
+ *    This file contains a scheduler which holds a list of tasks and runs them in order
+ *    of urgency. The main loop creates the tasks, registers each one with add() and a
+ *    priority, then calls run_once() over and over. Adding a task no longer means
+ *    editing the main loop.
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. 
+ */
+//======================================================================================
+
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "base_text_serial.h"				// Base class for various serial devices
+#include "stl_timer.h"						// Timer measures real time
+#include "stl_task.h"						// The state transition logic header
+#include "stl_scheduler.h"					// Header for this file
+
+
+//--------------------------------------------------------------------------------------
+/** This constructor creates an empty scheduler. 
+ *  @param a_timer A pointer to the timer which the tasks are scheduled by
+ *  @param debug_port A pointer to the serial (or radio) port to be used for debugging.
+ *                    Leave this parameter off for no serial debugging. 
+ */
+
+stl_scheduler::stl_scheduler (task_timer* a_timer, base_text_serial* debug_port)
+{
+	p_timer = a_timer;
+	dbg_port = debug_port;
+	num_tasks = 0;
+
+	clear_stats ();
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method registers a task with the scheduler. Tasks are kept sorted by priority
+ *  so that run_once() can stop looking once it has found a ready task.
+ *  @param a_task A pointer to the task to be run
+ *  @param priority The task's priority; a higher number is more urgent
+ *  @return True if the task was added, false if the task list is full
+ */
+
+bool stl_scheduler::add (stl_task* a_task, unsigned char priority)
+{
+	unsigned char index;
+
+	if (num_tasks >= STL_MAX_TASKS)
+	{
+		STL_DEBUG ("Scheduler full, task " << a_task->get_serial_number ()
+			<< " not added" << endl);
+		return (false);
+	}
+
+	// Move lower priority tasks down the list to make room; tasks with the same
+	// priority stay in the order they were added
+	for (index = num_tasks; (index > 0) && (priorities[index - 1] < priority); index--)
+	{
+		tasks[index] = tasks[index - 1];
+		priorities[index] = priorities[index - 1];
+	}
+	tasks[index] = a_task;
+	priorities[index] = priority;
+	num_tasks++;
+
+	return (true);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method makes one pass of the scheduler. It reads the time once, finds the most
+ *  urgent task which is ready to run and runs it. Only one task runs per pass, so a
+ *  higher priority task which becomes ready while a low priority one runs goes next.
+ *  @return A pointer to the task which was run, or NULL if no task was ready
+ */
+
+stl_task* stl_scheduler::run_once (void)
+{
+	time_stamp now = p_timer->get_time_now ();	// Copy, the timer reuses its own
+	stl_task* chosen = NULL;					// Most urgent ready task so far
+	unsigned char chosen_priority = 0;
+	long overhead;
+
+	for (unsigned char index = 0; index < num_tasks; index++)
+	{
+		// The list is sorted, so nothing further down can beat a task already found
+		if ((chosen != NULL) && (priorities[index] < chosen_priority))
+		{
+			break;
+		}
+
+		if (tasks[index]->is_due (now))
+		{
+			if ((chosen == NULL) 
+				|| !(tasks[index]->get_next_run_time () >= chosen->get_next_run_time ()))
+			{
+				chosen = tasks[index];
+				chosen_priority = priorities[index];
+			}
+		}
+	}
+
+	overhead = p_timer->get_time_now ().get_raw_time () - now.get_raw_time ();
+	passes++;
+	overhead_sum += overhead;
+	if (overhead > overhead_max)
+	{
+		overhead_max = overhead;
+	}
+
+	if (chosen != NULL)
+	{
+		runs++;
+		chosen->schedule (now);
+	}
+
+	return (chosen);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method puts the processor in idle sleep until the next task is due, instead of
+ *  spinning through run_once() until then. The wake up compare on the task timer is
+ *  set to the earliest run time; any other interrupt wakes the processor too, and the
+ *  task timer overflow does at least once per hardware count wrap, so run times further
+ *  off than that are just waited for in steps. After a wake which leaves no task due,
+ *  such as a timer tick whose ISR has done all there is to do, the processor goes
+ *  straight back to sleep without a pass through the main loop; tasks see what the 
+ *  interrupts did when they next run. Idle sleep keeps all the timers and the serial
+ *  port running. The deadline is checked with interrupts off and sleep follows sei() 
+ *  directly, so an interrupt can't slip in between and leave the processor asleep
+ *  past a deadline.
+ *  @return True if the processor slept, false if a task was already due
+ */
+
+bool stl_scheduler::idle (void)
+{
+	long now;									// Current time, microseconds
+	long next;									// Earliest run time, microseconds
+	bool waiting;								// Some task has a run time coming up
+	long left;									// Microseconds until that run time
+	bool slept = false;							// The processor has been asleep
+
+	set_sleep_mode (SLEEP_MODE_IDLE);
+
+	for (;;)
+	{
+		cli ();
+		now = task_timer::isr_raw_time ();
+		next = 0;
+		waiting = false;
+
+		for (unsigned char index = 0; index < num_tasks; index++)
+		{
+			long run_time = tasks[index]->get_next_run_time ().get_raw_time ();
+
+			if (tasks[index]->ready ())
+			{
+				sei ();
+				return (slept);
+			}
+			if (tasks[index]->get_op_state () == TASK_WAITING)
+			{
+				// Differences are used so the comparison works across the counter wrap
+				if (!waiting || ((run_time - next) < 0))
+				{
+					next = run_time;
+					waiting = true;
+				}
+			}
+		}
+
+		left = next - now;
+		if (waiting && (left <= STL_WAKE_MARGIN))
+		{
+			sei ();
+			return (slept);
+		}
+
+		// Only set the compare if the run time comes before the hardware counter wraps
+		// back round to it; otherwise the overflow interrupt wakes the processor first.
+		// The low bits of a microsecond time, shifted back up, are the hardware count
+		TMR_TIFR_REG = (1 << TMR_OCF_BIT);
+		if (waiting && (left < (1L << TMR_OVF_SHIFT)))
+		{
+			TMR_OCR_REG = (uint16_t)(next << TMR_US_SHIFT);
+			TMR_TIMSK_REG |= (1 << TMR_OCIE_BIT);
+		}
+
+		sleep_enable ();
+		sei ();
+		sleep_cpu ();
+		sleep_disable ();
+
+		TMR_TIMSK_REG &= ~(1 << TMR_OCIE_BIT);
+		slept = true;
+		sleeps++;
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method clears the overhead statistics, and the tasks' overrun statistics, so
+ *  they can be measured over a new stretch of time.
+ */
+
+void stl_scheduler::clear_stats (void)
+{
+	passes = 0;
+	runs = 0;
+	sleeps = 0;
+	overhead_sum = 0;
+	overhead_max = 0;
+
+	for (unsigned char index = 0; index < num_tasks; index++)
+	{
+		tasks[index]->clear_overruns ();
+		#ifdef STL_PROFILING
+			tasks[index]->clear_prof_data_method ();
+		#endif
+	}
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method returns how many times idle() has put the processor to sleep since the
+ *  statistics were last cleared. Each sleep ends in a wake, so this also counts the
+ *  interrupts which woke the processor with nothing due.
+ *  @return The number of sleeps
+ */
+
+unsigned long stl_scheduler::get_sleeps (void)
+{
+	return (sleeps);
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method writes the overhead statistics, and each task's overrun statistics,
+ *  to a serial port. The task timer counts in microseconds.
+ *  @param a_port A pointer to the serial port to write to
+ */
+
+void stl_scheduler::print_stats (base_text_serial* a_port)
+{
+	*a_port << endl << "Scheduler: " << num_tasks << " tasks, " << passes << " passes, "
+		<< runs << " runs, " << sleeps << " sleeps";
+	if (passes > 0)
+	{
+		*a_port << endl << "Overhead per pass (us): avg " << overhead_sum / (long)passes
+			<< ", max " << overhead_max;
+	}
+	for (unsigned char index = 0; index < num_tasks; index++)
+	{
+		*a_port << endl << "Task " << (int)tasks[index]->get_serial_number ()
+			<< ": " << tasks[index]->get_overruns () << " late, "
+			<< tasks[index]->get_dropped_runs () << " dropped, max late (us) "
+			<< tasks[index]->get_max_late ();
+	}
+	#ifdef STL_PROFILING
+		for (unsigned char index = 0; index < num_tasks; index++)
+		{
+			tasks[index]->print_profile_method (a_port);
+		}
+	#endif
+}
@@ -0,0 +1,76 @@
+//======================================================================================
+/** \file stl_scheduler.h
+ *	This file contains a scheduler which holds a list of tasks and runs them in order
+ *	of urgency. It takes the place of calling each task's schedule() method in turn
+ *	from the main loop, so a slow low priority task can't hold up a more important
+ *	one for more than one run.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but it is not limited thereto. 
+ */
+//======================================================================================
+
+/// This define prevents this .h file from being included more than once in a .cc file
+#ifndef _STL_SCHEDULER_H_
+#define _STL_SCHEDULER_H_
+
+#include "stl_timer.h"						// Include the header for the task timer
+#include "stl_task.h"						// Include the header for the task class
+
+
+/// This is the most tasks which can be registered with one scheduler
+#define STL_MAX_TASKS		8
+
+/// Microseconds before a deadline within which idle() doesn't bother sleeping, enough
+/// to set up the wake up compare before the counter gets there
+#define STL_WAKE_MARGIN		20
+
+
+//--------------------------------------------------------------------------------------
+/** This class implements a cooperative scheduler with priorities. Tasks are added
+ *  with add() and a priority; each call to run_once() runs the one task which is most
+ *  urgent: the highest priority task which is ready, and among tasks of the same
+ *  priority the one whose run time came up first. The time is read once per pass. The
+ *  scheduler measures its own overhead, the time from the start of a pass until the
+ *  task's run() method is called, so the cost of scheduling can be checked.
+ */
+
+class stl_scheduler
+{
+	protected:
+		/// This is a pointer to the timer which all the tasks use
+		task_timer* p_timer;
+
+		/// This is a pointer to a serial device used to send debugging information
+		base_text_serial* dbg_port;
+
+		/// These are the registered tasks, kept in order of priority, highest first
+		stl_task* tasks[STL_MAX_TASKS];
+
+		/// These are the priorities of the tasks; a higher number is more urgent
+		unsigned char priorities[STL_MAX_TASKS];
+
+		/// This is the number of tasks which have been registered
+		unsigned char num_tasks;
+
+		/// These are the overhead statistics, in microseconds
+		unsigned long passes;				///< Passes through run_once()
+		unsigned long runs;					///< Passes in which a task was run
+		unsigned long sleeps;				///< Times idle() put the processor to sleep
+		long overhead_sum;					///< Overhead of all passes added up
+		long overhead_max;					///< Worst overhead of one pass
+
+	public:
+		// The constructor makes an empty scheduler which uses the given timer
+		stl_scheduler (task_timer*, base_text_serial* = NULL);
+
+		bool add (stl_task*, unsigned char);	// Register a task with a priority
+		stl_task* run_once (void);				// Run the most urgent ready task
+		bool idle (void);						// Sleep until the next task is due
+		void clear_stats (void);				// Start the overhead statistics over
+		void print_stats (base_text_serial*);	// Write the overhead statistics
+		unsigned long get_sleeps (void);		// Times idle() has put the processor to sleep
+};
+
+#endif // _STL_SCHEDULER_H_
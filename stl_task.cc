@@ -27,8 +27,9 @@
  *        option causes the execution times of the state functions to be measured
  *        and a simple set of performance data to be kept. Performance data can be
  *        written to a serial port at a convenient time, generally after the system
- *        has been run in test for a while. 
- *        (NOTE: This is a future enhancement, not currently usable)
+ *        has been run in test for a while. For each state, the number of runs and
+ *        the least, mean and most run time are kept; for the task, a histogram of
+ *        how late it was released and the share of processor time it used. 
  * 
  *  Revisions
  *    \li 04-21-07 JRR Original of this file, derived from UCB's TranRun4 and
@@ -58,6 +59,27 @@
 char stl_task::serial_counter = 0;
 
 
+#ifdef STL_PROFILING
+//--------------------------------------------------------------------------------------
+/** This function reads the task timer for profiling. It may be called with interrupts
+ *  on or off and leaves them as they were. 
+ *  @return The current time as a raw time count
+ */
+
+static long prof_time (void)
+{
+	uint8_t sreg = SREG;					// Save the interrupt flag
+	long now;								// Current time, raw count
+
+	cli ();
+	now = task_timer::isr_raw_time ();
+	SREG = sreg;
+
+	return (now);
+}
+#endif  // STL_PROFILING
+
+
 //--------------------------------------------------------------------------------------
 /** This constructor creates a task object. It must be called by the constructor of 
  *  each task which is written by the user. This constructor sets the time between runs
@@ -89,6 +111,12 @@ stl_task::stl_task (const time_stamp& time_interval, base_text_serial* debug_por
 	// The task begins running in state 0, with no transitions unless called for
 	current_state = 0;
 
+	// Missed run times are caught up on, as they always have been, until a task is
+	// told otherwise
+	overrun_policy = STL_OVERRUN_CATCH_UP;
+	catch_up_limit = STL_CATCH_UP_ALL;
+	clear_overruns ();
+
 	// The next run time should have been initialized to zero, so the task will run
 	// its run() method as soon as possible in most cases
 
@@ -125,6 +153,37 @@ void stl_task::set_next_run_time (const time_stamp& next_time)
 }
 
 
+//--------------------------------------------------------------------------------------
+/** This method sets what the task does when it is released a whole interval or more
+ *  after its run time, having missed one or more run times because it or another task
+ *  took too long. A task which catches up runs back to back until it is back on time, 
+ *  which can keep lower priority tasks from running for a while; the limit bounds how
+ *  many extra runs that can be, and the rest of the missed run times are dropped.
+ *  @param policy What to do about missed run times
+ *  @param limit The most missed run times to catch up on with STL_OVERRUN_CATCH_UP,
+ *               or STL_CATCH_UP_ALL (the default) for no limit
+ */
+
+void stl_task::set_overrun_policy (stl_overrun_policy policy, unsigned char limit)
+{
+	overrun_policy = policy;
+	catch_up_limit = limit;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method clears the overrun statistics so they can be collected over a new 
+ *  stretch of time. 
+ */
+
+void stl_task::clear_overruns (void)
+{
+	overruns = 0;
+	dropped_runs = 0;
+	max_late = 0;
+}
+
+
 //--------------------------------------------------------------------------------------
 /** This method is called by the main task loop to try to run the task. If the task is
  *  in the waiting state, it checks to see if it's time to run yet; if it's in the
@@ -136,6 +195,14 @@ void stl_task::set_next_run_time (const time_stamp& next_time)
 bool stl_task::schedule (time_stamp& the_time)
 {
 	char next_state;						// State to which a task will transition
+	long late;								// Time since the task was due to run
+	long period = 0;						// Interval as a raw time count
+	long missed = 0;						// Run times missed since the one due
+	long drop = 0;							// Missed run times to be dropped
+	#ifdef STL_PROFILING
+		long prof_run_start;				// When run() was called
+		char prof_state;					// State run() was called in
+	#endif
 
 	switch (op_state)
 	{
@@ -149,6 +216,18 @@ bool stl_task::schedule (time_stamp& the_time)
 			if (!(the_time >= next_run_time))
 				return (false);
 
+			// Check how late the task is; a whole interval or more means run times
+			// have been missed
+			late = the_time.get_raw_time () - next_run_time.get_raw_time ();
+			if (late > max_late)
+				max_late = late;
+			period = interval.get_raw_time ();
+			if ((period > 0) && (late >= period))
+			{
+				missed = late / period;
+				overruns++;
+			}
+
 			// If we get here, it is time to run the task; just continue into the
 			// task_pending section below, which will cause the task to run right now
 
@@ -156,8 +235,19 @@ bool stl_task::schedule (time_stamp& the_time)
 			// Set the state to waiting for the next time interval. If the task needs
 			// to run again immediately, run_again_ASAP() will be called within the
 			// run() method, causing the state to be set to TASK_PENDING instead
+			#ifdef STL_PROFILING
+				prof_run_start = prof_time ();
+				prof_state = current_state;
+				if (op_state == TASK_WAITING)
+					profile_release (prof_run_start - next_run_time.get_raw_time ());
+			#endif
+
 			op_state = TASK_WAITING;
 			next_state = run (current_state);		// Call the run() method
+
+			#ifdef STL_PROFILING
+				profile_run (prof_state, prof_time () - prof_run_start);
+			#endif
 			if (next_state != STL_NO_TRANSITION)	// Detect state transition if any
 			{										// has occurred
 				STL_TRACE ("T" << serial_number << ":" << current_state << "-" 
@@ -167,7 +257,26 @@ bool stl_task::schedule (time_stamp& the_time)
 			}
 	
 			if (op_state == TASK_WAITING)			// Unless task needs to run again
-				next_run_time += interval;			// right away, set next run time
+			{										// right away, set next run time
+				if (missed > 0)						// after dropping the missed run
+				{									// times the policy doesn't run
+					if (overrun_policy == STL_OVERRUN_RUN_ONCE)
+					{
+						next_run_time = the_time;
+						drop = missed;
+					}
+					else if (overrun_policy == STL_OVERRUN_SKIP)
+						drop = missed;
+					else if ((catch_up_limit != STL_CATCH_UP_ALL) 
+						&& (missed > catch_up_limit))
+						drop = missed - catch_up_limit;
+
+					if (overrun_policy != STL_OVERRUN_RUN_ONCE)
+						next_run_time += time_stamp (drop * period);
+					dropped_runs += drop;
+				}
+				next_run_time += interval;
+			}
 
 			return (true);							// The task has run this time
 
@@ -183,6 +292,29 @@ bool stl_task::schedule (time_stamp& the_time)
 }
 
 
+//--------------------------------------------------------------------------------------
+/** This method checks whether schedule() would run the task at the given time, without
+ *  running it. It lets a scheduler pick which of several ready tasks to run first.
+ *  @param the_time The current time
+ *  @return True if the task is pending or its run time has come, false if not
+ */
+
+bool stl_task::is_due (time_stamp& the_time)
+{
+	switch (op_state)
+	{
+		case (TASK_PENDING):
+			return (true);
+
+		case (TASK_WAITING):
+			return (the_time >= next_run_time);
+
+		default:
+			return (false);
+	};
+}
+
+
 //--------------------------------------------------------------------------------------
 /** This is a base method which the user should overload in each descendent of this 
  *  task class. The run method is where all the user-defined action in the task takes
@@ -226,26 +358,72 @@ void stl_task::resume (void)
 }
 
 
+#ifdef STL_PROFILING
 //--------------------------------------------------------------------------------------
 /** This method clears the profile data arrays. It's called once at startup, and it can
  *  be called later in order to restart the execution time profiling process. Usually
- *  the user should not call this method but instead use the STL_CLEAR_PROF_DATA macro, 
+ *  the user should not call this method but instead use the STL_CLEAR_PROFILE macro, 
  *  which causes this method to disappear if profiling is deactivated. 
  */
 
-/*void stl_task::clear_prof_data_method (void)
+void stl_task::clear_prof_data_method (void)
 {
-	for (char count = 0; count < num_states; count++)
+	for (unsigned char count = 0; count < STL_PROF_STATES; count++)
 	{
 		num_runs[count] = 0;
-		max_entry_runtime[count] = 0;
-		sum_entry_runtime[count] = 0;
+		min_run_runtime[count] = 0;
 		max_run_runtime[count] = 0;
 		sum_run_runtime[count] = 0;
-		max_trans_runtime[count] = 0;
-		sum_trans_runtime[count] = 0;
 	}
-}*/
+	for (unsigned char bin = 0; bin < STL_PROF_BINS; bin++)
+	{
+		late_bins[bin] = 0;
+	}
+	prof_start = prof_time ();
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method counts a release of the task in the lateness histogram. The bins are 
+ *  found by shifting rather than dividing to keep the cost down. 
+ *  @param late How long after its run time the task was started, in microseconds
+ */
+
+void stl_task::profile_release (long late)
+{
+	unsigned char bin = 0;					// Bin the release goes into
+	long limit = STL_PROF_BIN_0;			// Upper end of that bin
+
+	while ((late >= limit) && (bin < STL_PROF_BINS - 1))
+	{
+		limit <<= 2;
+		bin++;
+	}
+	late_bins[bin]++;
+}
+
+
+//--------------------------------------------------------------------------------------
+/** This method adds a run of the task to the run time data of the state it ran in.
+ *  @param state The state run() was called in
+ *  @param duration How long run() took, in microseconds
+ */
+
+void stl_task::profile_run (char state, long duration)
+{
+	unsigned char index = (unsigned char)state;
+
+	if (index >= STL_PROF_STATES)
+		index = STL_PROF_STATES - 1;
+
+	if ((num_runs[index] == 0) || (duration < min_run_runtime[index]))
+		min_run_runtime[index] = duration;
+	if (duration > max_run_runtime[index])
+		max_run_runtime[index] = duration;
+	sum_run_runtime[index] += duration;
+	num_runs[index]++;
+}
+#endif  // STL_PROFILING
 
 
 //--------------------------------------------------------------------------------------
@@ -285,13 +463,48 @@ void stl_task::error_stop (char const* message)
 //--------------------------------------------------------------------------------------
 /** This method prints the results of execution speed profiling to the given serial
  *  port. It's called by the STL_PRINT_PROFILE() macro, which does nothing unless
- *  execution profiling has been turned on by defining STL_PROFILING. 
- *  @param a_port A pointer to an object of class uart which controls a serial port
+ *  execution profiling has been turned on by defining STL_PROFILING. Only states 
+ *  which have run are printed. Times are in microseconds. 
+ *  @param a_port A pointer to the serial port to write to
  */
 
-void stl_task::print_profile_method (avr_uart* a_port)
+void stl_task::print_profile_method (base_text_serial* a_port)
 {
-	a_port->puts ("Execution profiling not yet enabled\r\n");
+	long busy = 0;							// Time spent in run(), all states
+	long elapsed;							// Time since the data was cleared
+	long limit = STL_PROF_BIN_0;			// Upper end of a lateness bin
+
+	for (unsigned char count = 0; count < STL_PROF_STATES; count++)
+	{
+		busy += sum_run_runtime[count];
+	}
+	elapsed = (prof_time () - prof_start) / 1000;
+
+	*a_port << endl << "Task " << (int)serial_number << " profile, CPU ";
+	if (elapsed > 0)
+	{
+		*a_port << busy / elapsed << "/1000";
+	}
+	*a_port << endl << "State: runs, min/avg/max (us)";
+
+	for (unsigned char count = 0; count < STL_PROF_STATES; count++)
+	{
+		if (num_runs[count] == 0)
+			continue;
+
+		*a_port << endl << (int)count << ": " << num_runs[count] << ", " 
+			<< min_run_runtime[count] << "/" 
+			<< sum_run_runtime[count] / (long)num_runs[count] << "/"
+			<< max_run_runtime[count];
+	}
+
+	*a_port << endl << "Late (us):";
+	for (unsigned char bin = 0; bin < STL_PROF_BINS - 1; bin++)
+	{
+		*a_port << " <" << limit << ":" << late_bins[bin];
+		limit <<= 2;
+	}
+	*a_port << " more:" << late_bins[STL_PROF_BINS - 1];
 }
 
 #endif  // STL_PROFILING
@@ -61,10 +61,21 @@ const char STL_NO_TRANSITION = 0xFF;
  */
 #ifdef STL_PROFILING
 	#define STL_PRINT_PROFILE(x) print_profile_method(x) 
+	#define STL_CLEAR_PROFILE() clear_prof_data_method() 
 #else
 	#define STL_PRINT_PROFILE(x)
+	#define STL_CLEAR_PROFILE()
 #endif
 
+/// States numbered this or higher share the last state's profile data
+#define STL_PROF_STATES		18
+
+/// Release lateness is counted in this many bins, each 4 times as wide as the last
+#define STL_PROF_BINS		8
+
+/// The first lateness bin holds releases less than this many microseconds late
+#define STL_PROF_BIN_0		8
+
 
 //--------------------------------------------------------------------------------------
 /** This enumeration lists the possible operational states of a task. These states are 
@@ -83,6 +94,23 @@ enum task_op_state
 };
 
 
+//--------------------------------------------------------------------------------------
+/** This enumeration lists what a task does about run times it missed because it or 
+ *  another task took too long. A task has missed a run time when it is released a 
+ *  whole interval or more after the run time it was due at. 
+ */
+
+enum stl_overrun_policy
+{
+	STL_OVERRUN_CATCH_UP,	///< Run back to back for missed run times, up to a limit
+	STL_OVERRUN_SKIP,		///< Drop the missed run times, keeping to the original ones
+	STL_OVERRUN_RUN_ONCE	///< Drop the missed run times, count the interval from now
+};
+
+/// A catch up limit which lets a task run back to back for every run time it missed
+#define STL_CATCH_UP_ALL	0xFF
+
+
 //--------------------------------------------------------------------------------------
 /** This class implements the behavior of a task in the context of a multitasking
  *  system. Each task runs "simultaneously" with other tasks. This means, of course,
@@ -143,6 +171,21 @@ class stl_task
 		/// This is the state (as seen by the user) in which this task is right now
 		char current_state;
 
+		/// This is what the task does about run times it missed
+		stl_overrun_policy overrun_policy;
+
+		/// This is the most missed run times the task catches up on, or STL_CATCH_UP_ALL
+		unsigned char catch_up_limit;
+
+		/// This counts runs which were released a whole interval or more late
+		unsigned int overruns;
+
+		/// This counts run times which were dropped instead of being run
+		unsigned long dropped_runs;
+
+		/// This is the latest the task has been released after its run time, in us
+		long max_late;
+
 	protected:
 		/// This is the time at which the task should next be run
 		time_stamp next_run_time;
@@ -163,7 +206,14 @@ class stl_task
 		// This method sets the next time the task is to run
 		void set_next_run_time (const time_stamp&);
 
+		// This method sets what the task does about run times it missed
+		void set_overrun_policy (stl_overrun_policy, unsigned char = STL_CATCH_UP_ALL);
+
+		// This method starts the overrun statistics over
+		void clear_overruns (void);
+
 		bool schedule (time_stamp&);		// Scheduler calls this to try to run task
+		bool is_due (time_stamp&);			// Check if the task would run now
 		virtual char run (char);			// Base method which the user overloads
 		void suspend (void);				// Set operational state to suspended
 		void resume (void);					// Un-suspend a task so it can run again
@@ -174,6 +224,12 @@ class stl_task
 		 */
 		char get_serial_number (void) { return (serial_number); }
 
+		/** This method returns the time at which the task is next due to run. The
+		 *  scheduler uses it to choose between ready tasks of the same priority.
+		 *  @return A reference to the task's next run time
+		 */
+		time_stamp& get_next_run_time (void) { return (next_run_time); }
+
 		/** This method returns the state in which the task is currently. The state 
 		 *  cannot directly be changed by the user; it can only be changed through
 		 *  the returned value from the run() method.
@@ -188,6 +244,23 @@ class stl_task
 		 */
 		task_op_state get_op_state (void) { return (op_state); }
 
+		/** This method returns how many times the task has been released a whole 
+		 *  interval or more after it was due. 
+		 *  @return The number of late runs since the statistics were cleared
+		 */
+		unsigned int get_overruns (void) { return (overruns); }
+
+		/** This method returns how many run times the overrun policy dropped. 
+		 *  @return The number of dropped run times since the statistics were cleared
+		 */
+		unsigned long get_dropped_runs (void) { return (dropped_runs); }
+
+		/** This method returns the latest the task has been released after its run 
+		 *  time was due. 
+		 *  @return The latest release in microseconds
+		 */
+		long get_max_late (void) { return (max_late); }
+
 		/** This method will cause the task to run again as soon as it can instead of
 		 *  waiting for the given time interval. 
 		 */
@@ -205,12 +278,18 @@ class stl_task
 
 	#ifdef STL_PROFILING					// Stuff for execution time profiling
 	protected:
-		int *num_runs;						// All these variables are for collecting
-		long *max_run_runtime;				// test functions take to run 
-		long *sum_run_runtime;
+		unsigned long num_runs[STL_PROF_STATES];	// All these variables are for 
+		long min_run_runtime[STL_PROF_STATES];		// collecting data about how long
+		long max_run_runtime[STL_PROF_STATES];		// each state's run() takes, in
+		long sum_run_runtime[STL_PROF_STATES];		// microseconds
+		unsigned long late_bins[STL_PROF_BINS];		// Releases counted by lateness
+		long prof_start;							// When the data was cleared
 	public:
-		void print_profile_method (avr_uart*);	// Display execution time profile data
-		void clear_prof_data_method (void);		// Clear profiling data arrays
+		void print_profile_method (base_text_serial*);	// Display execution time profile
+		void clear_prof_data_method (void);				// Clear profiling data arrays
+	private:
+		void profile_release (long);			// Count a release by how late it was
+		void profile_run (char, long);			// Add up a run's execution time
 	#endif  // STL_PROFILING
 };
 
@@ -37,10 +37,11 @@
 // measured time whenever a timer interrupt occurs, and allow a timer object to read
 // the time. The user should not have any reason to read or write it.
 
-/** This variable holds the number of times the hardware timer has overflowed. This
- *  number is equivalent to the upper 16 bits of a 32-bit timer, and is so used. */
+/** This variable holds the number of times the hardware timer has overflowed. It is
+ *  32 bits wide so that, shifted up past the hardware count, it fills all 32 bits of
+ *  the microsecond count. */
 
-unsigned int ust_overflows = 0;
+volatile unsigned long ust_overflows = 0;
 
 
 //--------------------------------------------------------------------------------------
@@ -97,14 +98,13 @@ void time_stamp::set_time (long a_time)
 
 void time_stamp::set_time (int sec, long microsec)
 {
-	data.whole = (microsec * (CPU_FREQ_Hz / 1000000UL)) / 8UL;
-	data.whole += (unsigned int)sec * (CPU_FREQ_Hz / 8UL);
+	data.whole = microsec + (unsigned int)sec * 1000000L;
 }
 
 
 //--------------------------------------------------------------------------------------
 /** This method allows one to get the time reading from this time stamp as a long 
- *  integer containing the number of time ticks. 
+ *  integer containing the number of microseconds. 
  *  @return The time stamp's raw data
  */
 
@@ -115,13 +115,14 @@ long time_stamp::get_raw_time (void)
 
 
 //--------------------------------------------------------------------------------------
-/** This method returns the number of seconds in the time stamp.
+/** This method returns the number of seconds in the time stamp. The count is taken as
+ *  unsigned, so a time past the halfway point of the wrap doesn't come out negative.
  *  @return The number of whole seconds in the time stamp
  */
 
 int time_stamp::get_seconds (void)
 {
-	return ((int)(data.whole / (CPU_FREQ_Hz / 8)));
+	return ((int)((unsigned long)data.whole / 1000000UL));
 }
 
 
@@ -133,7 +134,7 @@ int time_stamp::get_seconds (void)
 
 long time_stamp::get_microsec (void)
 {
-	return ((data.whole % (CPU_FREQ_Hz / 8UL)) / ((CPU_FREQ_Hz / 1000000UL) / 8UL));
+	return ((long)((unsigned long)data.whole % 1000000UL));
 }
 
 
@@ -218,19 +219,20 @@ bool time_stamp::operator == (const time_stamp& other)
  *  this method is a lot easier (and more efficient) than writing another one. The
  *  method used to check greater-than-ness needs to work across timer overflows, so
  *  the following technique is used: subtract the other time stamp from this one as
- *  unsigned 32-bit numbers, then check if the result is positive (in which case this 
- *  time is greater) or not. 
+ *  unsigned 32-bit numbers, then check if the result, taken as signed, is zero or 
+ *  positive (in which case this time is greater or equal) or not. This is right 
+ *  whenever the two times are less than half the wrap, 35.8 minutes, apart. 
  *  @param other A time stamp to be compared to this one 
  *  @return True if this time stamp is greater than or equal to the other one
  */
 
 bool time_stamp::operator >= (const time_stamp& other)
 {
-	long difference;						// Vive la difference
+	unsigned long difference;				// Vive la difference
 
-	difference = data.whole - other.data.whole;
+	difference = (unsigned long)data.whole - (unsigned long)other.data.whole;
 
-	if ((signed long)difference > 0L)
+	if ((signed long)difference >= 0L)
 		return (true);
 	else
 		return (false);
@@ -239,7 +241,7 @@ bool time_stamp::operator >= (const time_stamp& other)
 
 //--------------------------------------------------------------------------------------
 /** This constructor creates a daytime task timer object.  It sets up the hardware timer
- *  to count at ~1 MHz and interrupt on overflow. Note that this method does not enable
+ *  to count at the clock / 8 and interrupt on overflow. Note that this method does not enable
  *  interrupts globally, so the user must call sei() at some point to enable the timer
  *  interrupts to run and time to actually be measured. 
  */
@@ -266,16 +268,18 @@ task_timer::task_timer (void)
 /** This method grabs the current time stamp from the hardware and overflow counters. 
  *  In order to prevent the data changing during the time when it's being read (which 
  *  would cause invalid data to be saved), interrupts are disabled while the time data 
- *  is being copied. 
+ *  is being copied. They are put back the way they were afterwards, so this method 
+ *  can be used inside an ISR too. 
  *  @param the_stamp Reference to a time stamp variable which will hold the time
  */
 
 void task_timer::save_time_stamp (time_stamp& the_stamp)
 {
+	uint8_t sreg = SREG;					// Save the interrupt flag
+
 	cli ();									// Prevent interruption
-	the_stamp.data.half[0] = TMR_TCNT_REG;	// Get hardware count
-	the_stamp.data.half[1] = ust_overflows;	// Get overflow counter data
-	sei ();									// Re-enable interrupts
+	the_stamp.data.whole = isr_raw_time ();
+	SREG = sreg;							// Re-enable interrupts if they were on
 }
 
 
@@ -287,15 +291,39 @@ void task_timer::save_time_stamp (time_stamp& the_stamp)
 
 time_stamp& task_timer::get_time_now (void)
 {
-	cli ();									// Prevent interruption
-	now_time.data.half[0] = TMR_TCNT_REG;	// Get hardware count
-	now_time.data.half[1] = ust_overflows;	// Get overflow counter data
-	sei ();									// Re-enable interrupts
+	save_time_stamp (now_time);
 
 	return (now_time);						// Return a reference to the current time
 }
 
 
+//--------------------------------------------------------------------------------------
+/** This method reads the current time with interrupts off, as they are inside an 
+ *  interrupt service routine; it leaves the global interrupt flag alone. Since the 
+ *  overflow interrupt can't run until interrupts are back on, an overflow which has 
+ *  happened but not yet been counted is added in here; a low hardware count means the
+ *  overflow came before the count was read. Without this, a time read just after an 
+ *  overflow would be 32 ms early and time would seem to run backwards. 
+ *  @return The current time as a raw 32-bit count of microseconds
+ */
+
+long task_timer::isr_raw_time (void)
+{
+	uint16_t count;							// Hardware count
+	unsigned long overflows;				// Overflow count
+
+	count = TMR_TCNT_REG;
+	overflows = ust_overflows;
+
+	if ((TMR_TIFR_REG & (1 << TMR_TOV_BIT)) && (count < 0x8000))
+	{
+		overflows++;
+	}
+
+	return ((long)((overflows << TMR_OVF_SHIFT) | (count >> TMR_US_SHIFT)));
+}
+
+
 //--------------------------------------------------------------------------------------
 /** This method sets the timer to a given value. It's not likely that this method will
  *  be used, but it is provided for compatibility with other task timer implementations
@@ -306,10 +334,15 @@ time_stamp& task_timer::get_time_now (void)
 
 bool task_timer::set_time (time_stamp& t_stamp)
 {
+	unsigned long now = (unsigned long)t_stamp.data.whole;
+
 	cli ();									// Prevent interruption
-	TMR_TCNT_REG = t_stamp.data.half[0];
-	ust_overflows = t_stamp.data.half[1];
+	TMR_TCNT_REG = (uint16_t)(now << TMR_US_SHIFT);
+	ust_overflows = now >> TMR_OVF_SHIFT;
+	TMR_TIFR_REG = (1 << TMR_TOV_BIT);		// Don't count an overflow from before
 	sei ();									// Re-enable interrupts
+
+	return (true);
 }
 
 
@@ -354,6 +387,14 @@ ISR (TMR_intr_vect)
 	ust_overflows++;
 }
 
+
+//--------------------------------------------------------------------------------------
+/** This interrupt only wakes the processor up when the next task is due; see 
+ *  stl_scheduler::idle(). There is nothing for it to do.
+ */
+
+EMPTY_INTERRUPT (TMR_comp_vect);
+
 /** This function tells you if a certain amount of time has passed.  
  *  If the difference between the time stamps is greater than the second and microseconds you feed
  *  it, it will return true
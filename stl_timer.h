@@ -34,23 +34,48 @@
 	#error The macro CPU_FREQ_Hz must be set in the Makefile.
 #endif
 
+// The hardware timer runs at the clock / 8; its count is shifted right by this much to
+// get microseconds
+#if CPU_FREQ_Hz == 16000000UL
+	#define TMR_US_SHIFT	1				///< 2 counts per microsecond
+#elif CPU_FREQ_Hz == 8000000UL
+	#define TMR_US_SHIFT	0				///< 1 count per microsecond
+#else
+	#error The task timer only counts microseconds with an 8 or 16 MHz clock.
+#endif
+
+/// Microseconds per hardware timer overflow, as a power of 2
+#define TMR_OVF_SHIFT		(16 - TMR_US_SHIFT)
+
 // If Timer 3 exists (as on the ATmega128), we use it for the microsecond timer rather
 // than Timer 1, as Timer 1 is used for the motor PWM's on the ME405 board
 #ifdef TCNT3
 	#define TMR_TCNT_REG	TCNT3			///< Register that holds the time count
 	#define TMR_intr_vect   TIMER3_OVF_vect	///< The timer overflow interrupt vector 
+	#define TMR_TIFR_REG	TIFR3			///< Register that holds the overflow flag
+	#define TMR_TOV_BIT		TOV3			///< Overflow flag bit
+	#define TMR_OCR_REG		OCR3A			///< Compare register used to wake from sleep
+	#define TMR_comp_vect	TIMER3_COMPA_vect	///< The wake up compare interrupt vector
+	#define TMR_TIMSK_REG	TIMSK3			///< Register that enables the timer interrupts
+	#define TMR_OCIE_BIT	OCIE3A			///< Wake up compare interrupt enable bit
+	#define TMR_OCF_BIT		OCF3A			///< Wake up compare flag bit
 #else
 	#define TMR_TCNT_REG	TCNT1			///< Register that holds the time count
 	#define TMR_intr_vect   TIMER1_OVF_vect	///< The timer overflow interrupt vector 
+	#define TMR_TIFR_REG	TIFR1			///< Register that holds the overflow flag
+	#define TMR_TOV_BIT		TOV1			///< Overflow flag bit
+	#define TMR_OCR_REG		OCR1A			///< Compare register used to wake from sleep
+	#define TMR_comp_vect	TIMER1_COMPA_vect	///< The wake up compare interrupt vector
+	#define TMR_TIMSK_REG	TIMSK1			///< Register that enables the timer interrupts
+	#define TMR_OCIE_BIT	OCIE1A			///< Wake up compare interrupt enable bit
+	#define TMR_OCF_BIT		OCF1A			///< Wake up compare flag bit
 #endif // __AVR_ATmega128__
 
 
 //--------------------------------------------------------------------------------------
 /** This union holds a 32-bit time count. The count can be accessed as a single 32-bit
  *  number, as two 16-bit integers placed together, or as an array of 8-bit characters. 
- *  This is helpful because the time measurement we use consists of the number in a 
- *  16-bit hardware counter and a 16-bit overflow count which should be put together 
- *  into one time number. The characters are handy for looking at individual bits. 
+ *  The characters are handy for looking at individual bits. 
  */
 
 typedef union
@@ -64,10 +89,11 @@ typedef union
 //--------------------------------------------------------------------------------------
 /** This class holds a time stamp which is used to measure the passage of real time in
  *  the world around an AVR processor. This version of the time stamp implements a 
- *  32-bit time counter that runs at one megahertz. There's a 16-bit number which is
- *  copied directly from a 16-bit hardware counter and another 16-bit number which is 
- *  incremented every time the hardware counter overflows; the combination of the two 
- *  is a 32-bit time measurement. 
+ *  32-bit time counter that counts microseconds. It is put together from a 16-bit 
+ *  hardware counter and a count of that counter's overflows. The count wraps around 
+ *  every 71.6 minutes; comparisons are made on the difference between two times, so
+ *  they stay right across the wrap as long as the times are within 35.8 minutes of 
+ *  each other. 
  */
 
 class time_stamp
@@ -132,11 +158,11 @@ class time_stamp
 //--------------------------------------------------------------------------------------
 /** This class implements a timer to synchronize the operation of tasks on an AVR. The
  *  timer is implemented as a combination of a 16-bit hardware timer (Timer 1 is the 
- *  usual choice) and a 16-bit overflow counter. The two timers' data is combined to
- *  produce a 32-bit time count which is used to decide when tasks run. WARNING: This
- *  timer does not keep track of the time of day, and it overflows after a little more
- *  than an hour of use. Another timer (see stl_timer.h/cc) works when longer time
- *  periods need to be kept track of, to lower precision. 
+ *  usual choice) and a 32-bit overflow counter. The two timers' data is combined to
+ *  produce a 32-bit count of microseconds which is used to decide when tasks run. 
+ *  WARNING: This timer does not keep track of the time of day. Its count wraps around
+ *  after 71.6 minutes, which time stamp comparisons allow for, so tasks keep running
+ *  on time for as long as the processor does. 
  */
 
 class task_timer
@@ -149,6 +175,7 @@ class task_timer
 		task_timer (void);					/// Constructor creates an empty timer
 		void save_time_stamp (time_stamp&);	/// Save current time in a timestamp
 		time_stamp& get_time_now (void);	/// Get the current time
+		static long isr_raw_time (void);	/// Get the current time with interrupts off
 
 		/// This method sets the current time to the time in the given time stamp
 		bool set_time (time_stamp&);
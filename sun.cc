@@ -0,0 +1,188 @@
+//*************************************************************************************
+/** \file sun.cc
+ *	Sunrise, sunset and civil twilight times worked out on the board. The sun's
+ *	position comes from the Astronomical Almanac's low precision formulas (mean
+ *	longitude and anomaly counted in days from J2000, good to 0.01 degree this
+ *	century), and the hour angle of the sun at a given zenith angle, as in the NOAA
+ *	solar calculator, from
+ *		cos(ha) = (cos(zenith) - sin(lat) sin(decl)) / (cos(lat) cos(decl))
+ *	Each event is worked out at noon first and then again at the time found, since the
+ *	declination moves a little over half a day. test/test_sun.cc checks the times
+ *	against a reference table to 2 minutes up to 60 degrees north or south.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdlib.h>			// Standard C library
+#include <avr/pgmspace.h>	// Tables kept in flash
+#include "fixed_point.h"	// Integer trig
+#include "sun.h"			// Header for this file
+
+
+/// cos(zenith) in Q15 at sunrise (90.833 degrees, refraction and the sun's radius)
+#define SUN_COS_ZENITH_RISE		-476
+/// cos(zenith) in Q15 at the ends of civil twilight (96 degrees)
+#define SUN_COS_ZENITH_CIVIL	-3425
+
+/// Mean longitude of the sun at J2000 (2000-01-01 12:00 UTC), in 2^-32 turns
+#define SUN_L0				3346018133UL
+/// Mean longitude gained per day, in 2^-32 turns
+#define SUN_L_PER_DAY		11759232UL
+/// Mean anomaly of the sun at J2000, in 2^-32 turns
+#define SUN_G0				4265475187UL
+/// Mean anomaly gained per day, in 2^-32 turns
+#define SUN_G_PER_DAY		11758670UL
+/// Mean longitude and anomaly gained per second, in 2^-38 turns (both round to this)
+#define SUN_PER_SECOND_64	8710L
+/// Obliquity of the ecliptic at J2000 in binary angle units
+#define SUN_OBLIQUITY		4267
+/// Days for the obliquity to drop by one binary angle unit
+#define SUN_OBLIQUITY_DAYS	13733
+
+/// Days before the first of each month in a year that isn't a leap year
+static const uint16_t month_start[12] PROGMEM =
+{
+	0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out where the sun is at a time of day: its declination and
+ *	the equation of time (how far the sun is ahead of the clock). Angles in turns are
+ *	kept in 32 bits, so multiplying by a day count can overflow freely; the whole
+ *	turns that fall off don't matter.
+ *  @param day			Days from 2000-01-01 to the date
+ *  @param utc_s		Time of day in seconds (UTC), may be off either end of the day
+ *  @param decl			Where to put the declination, in binary angle units
+ *  @param eqtime_s		Where to put the equation of time, in seconds
+ */
+static void sun_position(int32_t day, int32_t utc_s, int16_t* decl, int16_t* eqtime_s)
+{
+	int32_t since_noon = ((utc_s - 43200) * SUN_PER_SECOND_64) / 64;
+	uint16_t mean_long;			//mean longitude in binary angle units
+	uint16_t anomaly;			//mean anomaly in binary angle units
+	uint16_t ecl_long;			//ecliptic longitude in binary angle units
+	uint16_t obliquity;
+	int32_t sum;
+
+	mean_long = (uint16_t)((SUN_L0 + SUN_L_PER_DAY * (uint32_t)day + (uint32_t)since_noon) >> 16);
+	anomaly = (uint16_t)((SUN_G0 + SUN_G_PER_DAY * (uint32_t)day + (uint32_t)since_noon) >> 16);
+
+	//ecliptic longitude, the equation of centre in eighths of a binary angle unit
+	sum = (2789L * fx_sin_q15(anomaly)) >> 15;
+	sum += (29L * fx_sin_q15(2 * anomaly)) >> 15;
+	ecl_long = mean_long + (uint16_t)(int16_t)((sum + 4) >> 3);
+
+	//sin(decl) = sin(obliquity) sin(ecliptic longitude)
+	obliquity = SUN_OBLIQUITY - (int16_t)(day / SUN_OBLIQUITY_DAYS);
+	sum = (fx_sin_q15(obliquity) * fx_sin_q15(ecl_long)) >> 15;
+	*decl = (int16_t)(FX_BAM_90 - fx_acos_bam(sum));
+
+	//equation of time, mean longitude less right ascension, in eighths of a second
+	sum = (-3677L * fx_sin_q15(anomaly)) >> 15;
+	sum += (-38L * fx_sin_q15(2 * anomaly)) >> 15;
+	sum += (4735L * fx_sin_q15(2 * ecl_long)) >> 15;
+	sum += (-102L * fx_sin_q15(4 * ecl_long)) >> 15;
+	*eqtime_s = (int16_t)(sum / 8);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out when the sun crosses a zenith angle.
+ *  @param day			Days from 2000-01-01 to the date
+ *  @param lat			Latitude in binary angle units, north positive
+ *  @param lon_s		Longitude as a time, 240 s per degree, east positive
+ *  @param cos_zenith	cos(zenith angle) in Q15
+ *  @param rising		True for the morning crossing, false for the evening
+ *  @param utc_s		Where to put the time in seconds (UTC), may be off either end
+ *  @return False if the sun doesn't cross that zenith angle that day
+ */
+static bool sun_event(int32_t day, int16_t lat, int32_t lon_s, int32_t cos_zenith, bool rising, int32_t* utc_s)
+{
+	int32_t t = 43200;			//first guess, noon
+	int16_t decl;
+	int16_t eqtime_s;
+	int32_t num;
+	int32_t den;
+	int32_t ha_s;				//hour angle as a time, 240 s per degree
+
+	for (uint8_t pass = 0; pass < 2; pass++)
+	{
+		sun_position(day, t, &decl, &eqtime_s);
+
+		num = cos_zenith - ((fx_sin_q15(lat) * fx_sin_q15(decl)) >> 15);
+		den = (fx_cos_q15(lat) * fx_cos_q15(decl)) >> 15;
+		if ((den <= 0) || (num >= den) || (num <= -den))
+		{
+			return false;
+		}
+
+		ha_s = ((int32_t)fx_acos_bam((num << 15) / den) * 675) / 512;
+		t = 43200 - lon_s - eqtime_s + (rising ? -ha_s : ha_s);
+	}
+
+	*utc_s = t;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function turns a UTC time in seconds into minutes after local midnight.
+ *  @param utc_s		Time in seconds (UTC), may be off either end of the day
+ *  @param utc_offset	Local time minus UTC, in minutes
+ *  @return Minutes after local midnight, 0 to 1439
+ */
+static int16_t sun_local_minutes(int32_t utc_s, int16_t utc_offset)
+{
+	int32_t m = (utc_s + 30) / 60 + utc_offset;
+
+	while (m < 0)
+	{
+		m += 1440;
+	}
+	return (int16_t)(m % 1440);
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This function works out the dawn, sunrise, sunset and dusk times of a day.
+ *  @param lat			Latitude in hundredths of a degree, north positive
+ *  @param lon			Longitude in hundredths of a degree, east positive
+ *  @param utc_offset	Local time minus UTC, in minutes
+ *  @param year			Year, 2000 to 2099
+ *  @param month		Month, 1 to 12
+ *  @param dom			Day of the month
+ *  @param times		Where to put the times, in minutes after local midnight
+ */
+void sun_calc(int16_t lat, int16_t lon, int16_t utc_offset, uint16_t year, uint8_t month, uint8_t dom, sun_times* times)
+{
+	bool leap = ((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0));
+	int32_t years = (int32_t)year - 2000;
+	int32_t day;
+	int16_t lat_bam = (int16_t)(((int32_t)lat * 2048) / 1125);
+	int32_t lon_s = ((int32_t)lon * 12) / 5;
+	int32_t t;
+
+	if ((month < 1) || (month > 12))
+	{
+		month = 1;
+	}
+	//days from 2000-01-01, counting the leap days of the years before this one
+	day = years * 365 + (years + 3) / 4 - (years + 99) / 100 + (years + 399) / 400;
+	day += pgm_read_word(&month_start[month - 1]) + dom - 1;
+	if (leap && (month > 2))
+	{
+		day++;
+	}
+
+	times->dawn = sun_event(day, lat_bam, lon_s, SUN_COS_ZENITH_CIVIL, true, &t) ? sun_local_minutes(t, utc_offset) : SUN_NONE;
+	times->sunrise = sun_event(day, lat_bam, lon_s, SUN_COS_ZENITH_RISE, true, &t) ? sun_local_minutes(t, utc_offset) : SUN_NONE;
+	times->sunset = sun_event(day, lat_bam, lon_s, SUN_COS_ZENITH_RISE, false, &t) ? sun_local_minutes(t, utc_offset) : SUN_NONE;
+	times->dusk = sun_event(day, lat_bam, lon_s, SUN_COS_ZENITH_CIVIL, false, &t) ? sun_local_minutes(t, utc_offset) : SUN_NONE;
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,43 @@
+//*************************************************************************************
+/** \file sun.h
+ *	Sunrise, sunset and civil twilight times worked out on the board from the latitude,
+ *	longitude and date in the menu EEPROM, for planning runs across dawn and dusk. All
+ *	of it is integer math (see fixed_point.h). menu.c calls it, so it has C linkage.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _SUN_H_
+#define _SUN_H_                     	///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Time given for an event that doesn't happen that day (midnight sun or polar night)
+#define SUN_NONE		-1
+
+//Times of one day, in minutes after local midnight, or SUN_NONE
+typedef struct
+{
+	int16_t dawn;				// start of civil twilight, sun 6 degrees below the horizon
+	int16_t sunrise;			// top of the sun on the horizon, allowing for refraction
+	int16_t sunset;
+	int16_t dusk;				// end of civil twilight
+} sun_times;
+
+void sun_calc(int16_t, int16_t, int16_t, uint16_t, uint8_t, uint8_t, sun_times*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,132 @@
+//*************************************************************************************
+/** \file task_log.cc
+ *	Frame log for deflicker and motion blur correction in post. The Timer 5 ISR in
+ *	timescape.cc writes a record into a RAM ring each time a shutter closes; this task
+ *	sends everything waiting in the ring out of the serial port as one binary packet:
+ *		FRAME_LOG_SYNC, count, dropped (2 bytes), count records, checksum
+ *	Each record is the 14 bytes of a frame_record, low byte first, with the times in
+ *	task_timer microseconds. The dropped count is the running total of records lost
+ *	to a full ring, and the checksum is the low byte of the sum of every byte after
+ *	the sync byte.
+ *
+ *   -------------------------------STATES DEFINITION----------------------------------
+ *   State 0 = Write the column header
+ *   State 1 = Send the records waiting in the ring, up to FRAME_LOG_BURST, as a packet
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. 
+ */
+//*************************************************************************************
+
+#include <stdlib.h>				//standard avr library
+#include <avr/io.h>             //standard avr io library
+#include <avr/interrupt.h>		//standard library
+
+#include "rs232.h"				//custom library for USB serial communication
+#include "stl_timer.h"			//custom library for handling timer control.
+#include "stl_task.h"			//custom library for handling creating tasks.
+#include "task_log.h"			//.h file for this task log class. <this class>
+
+
+//-------------------------------------------------------------------------------------
+/** This constructor creates a frame log task object.
+ *  @param t_stamp 	A timestamp which contains the time between runs of this task
+ *  @param p_ser	A pointer to the serial port the records go out of
+ */
+
+task_log::task_log (time_stamp* t_stamp, base_text_serial* p_ser)
+	: stl_task (*t_stamp, p_ser)
+{
+	p_serial = p_ser;
+	droppedReported = 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This is the function which runs when it is called by the task scheduler. The
+ *	record count is fixed when the run starts so the packet header can go first; each
+ *	record is then copied out of the ring with interrupts off and written with them
+ *	on, so the ISR is only held up for the copy.
+ *  @param state The state of the task when this run method begins running
+ *  @return The state to which the task will transition, or STL_NO_TRANSITION if no
+ *	  transition is called for at this time
+ */
+
+char task_log::run (char state)
+{
+	switch (state)
+	{
+		// State 0: say what the packets hold, once, for anyone reading the port as text
+		case (0):
+		{
+			*p_serial <<endl <<"#F binary frame log: A5 n dropped n*(frame open close position) sum";
+			return (1);
+			break;
+		}
+		
+		// State 1: send what has come in since the last run
+		case (1):
+		{
+			frame_record record;
+			uint16_t dropped;
+			uint8_t count;
+			uint8_t sum;
+			uint8_t sreg;
+			
+			sreg = SREG;
+			cli();
+			count = (frame_ring_head - frame_ring_tail) & (FRAME_LOG_SIZE - 1);
+			dropped = frame_ring_dropped;
+			SREG = sreg;
+			
+			if (count > FRAME_LOG_BURST)
+				count = FRAME_LOG_BURST;
+			if (count == 0 && dropped == droppedReported)
+				return (STL_NO_TRANSITION);
+			
+			p_serial->putchar (FRAME_LOG_SYNC);
+			sum = count + (uint8_t)dropped + (uint8_t)(dropped >> 8);
+			p_serial->putchar (count);
+			p_serial->putchar ((uint8_t)dropped);
+			p_serial->putchar ((uint8_t)(dropped >> 8));
+			
+			// The ISR only writes at the head, so the records counted above stay put
+			for (uint8_t sent = 0; sent < count; sent++)
+			{
+				sreg = SREG;
+				cli();
+				record.frame = frame_ring[frame_ring_tail].frame;
+				record.open_time = frame_ring[frame_ring_tail].open_time;
+				record.close_time = frame_ring[frame_ring_tail].close_time;
+				record.position = frame_ring[frame_ring_tail].position;
+				frame_ring_tail = (frame_ring_tail + 1) & (FRAME_LOG_SIZE - 1);
+				SREG = sreg;
+				
+				// The AVR is little endian and packs the struct, so its bytes go as is
+				for (uint8_t i = 0; i < sizeof (frame_record); i++)
+				{
+					sum += ((uint8_t*)&record)[i];
+					p_serial->putchar (((uint8_t*)&record)[i]);
+				}
+			}
+			
+			p_serial->putchar (sum);
+			droppedReported = dropped;
+			
+			return (STL_NO_TRANSITION);
+			break;
+		}
+		
+		// If the state isn't a known state, call Houston; we have a problem
+		default:
+			STL_DEBUG ("WARNING: Frame log task in state " << state << endl);
+			return (0);
+	};
+
+	// If we get here, no transition is called for
+	return (STL_NO_TRANSITION);
+}
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -0,0 +1,56 @@
+//*************************************************************************************
+/** \file task_log.h
+ *	Frame log for deflicker and motion blur correction in post. The Timer 5 ISR in
+ *	timescape.cc writes a record into a RAM ring each time a shutter closes: the frame
+ *	number, the task_timer time the shutter opened and closed, and the slide position
+ *	when it opened. This low priority task sends the waiting records out of the serial
+ *	port together as one binary packet, so writing them never holds up the shutter
+ *	timing.
+ *
+ *  License:
+ *    This file released under the Lesser GNU Public License, version 2. This program
+ *    is intended for educational use only, but it is not limited thereto. 
+ */
+//*************************************************************************************
+
+#ifndef _TASK_LOG_H_
+#define _TASK_LOG_H_
+
+#define FRAME_LOG_SIZE		16			///< Records the ring holds, a power of 2
+#define FRAME_LOG_BURST		8			///< Most records in one packet, 119 bytes or ~125 ms at 9600 baud
+#define FRAME_LOG_SYNC		0xA5		///< First byte of every frame log packet
+
+//One frame in the log, 14 bytes
+typedef struct
+{
+	uint16_t frame;				// frame number, the same for every shot of a bracket
+	long open_time;				// task_timer us when the shutter opened
+	long close_time;			// task_timer us when the last shutter closed
+	long position;				// slide position in steps when the shutter opened
+} frame_record;
+
+extern volatile frame_record frame_ring[FRAME_LOG_SIZE];	// records waiting to be sent
+extern volatile uint8_t frame_ring_head;		// next record the ISR writes
+extern volatile uint8_t frame_ring_tail;		// next record the task sends
+extern volatile uint16_t frame_ring_dropped;	// records lost because the ring was full
+
+class task_log : public stl_task
+{
+	protected:
+		
+		//Pointers
+		base_text_serial* p_serial;		///< Pointer to a serial port for the records
+		
+	public:
+		// The constructor creates a new task object
+		task_log (time_stamp*, base_text_serial*);
+          char run (char);
+		
+		uint16_t droppedReported;		///< Dropped count already written out
+
+};
+
+#endif
+
+// following line turns on automatic (because I am lazy or smart, there is a fine line) indentation for Kate editor.
+// kate: space-indent on; indent-width 5; mixedindent off; indent-mode cstyle;
@@ -64,6 +64,11 @@
 //button press delay, prevent multiple keypress
 #define BUTTON_PRESSDELAYMS 300
 
+//low power runs read the buttons this often, in us, with the ADC only on for the
+//  reading, and blank the LCD after this many reads with nothing pressed
+#define LOWPOWER_POLL_US 200000L
+#define LOWPOWER_LCD_READS 50
+
 //button repetition counter
 #define BUTTON_PRESSCOUNTMAX10 10
 #define BUTTON_PRESSCOUNTMAX100 20
@@ -143,6 +148,10 @@ char task_menu::run (char state)
 			int8_t button_pressprev = 0;
 			//*p_serial << endl << GetMotorRPM();
 			menuitem_initialize();
+			
+			lcdIdle = 0;
+			lcdOn = true;
+			lowPowerMenu = false;
 
 			return(1);
 
@@ -154,10 +163,62 @@ char task_menu::run (char state)
 		case (1):
 		{
 
-			button_adc = p_adc->read_once(BUTTON_CHANNEL,0);
+			//back from a low power run, ADC and LCD on for good
+			if (lowPowerMenu && !lowPowerRun)
+			{
+				set_interval (menuInterval);
+				p_adc->adc_on();
+				lcd_command(LCD_DISP_ON);
+				lcdOn = true;
+				lcdIdle = 0;
+				lowPowerMenu = false;
+			}
+			
+			if (lowPowerRun)
+			{
+				//the buttons are only looked at now and then, so the processor can
+				//  sleep in between
+				if (!lowPowerMenu)
+				{
+					lowPowerMenu = true;
+					menuInterval = interval;
+					set_interval (time_stamp (0, LOWPOWER_POLL_US));
+				}
+				
+				p_adc->adc_on();
+				button_adc = p_adc->read_once(BUTTON_CHANNEL,0);
+				p_adc->adc_off();
+			}
+			else
+			{
+				button_adc = p_adc->read_once(BUTTON_CHANNEL,0);
+			}
 
 			//get button pressed
 			button_press = get_button(button_adc);
+			
+			//In a low power run the LCD is only on for a while after a button. The
+			//  press that wakes it does nothing else
+			if (lowPowerRun)
+			{
+				if (button_press != -1)
+				{
+					lcdIdle = 0;
+					if (!lcdOn)
+					{
+						lcd_command(LCD_DISP_ON);
+						lcdOn = true;
+						button_pressprev = button_press;
+						_delay_ms(BUTTON_PRESSDELAYMS);
+						return (STL_NO_TRANSITION);
+					}
+				}
+				else if (lcdOn && (++lcdIdle >= LOWPOWER_LCD_READS))
+				{
+					lcd_command(LCD_DISP_OFF);
+					lcdOn = false;
+				}
+			}
 
 			//simple timer count for multipress
 			if(button_pressprev == button_press) 
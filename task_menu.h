@@ -42,6 +42,10 @@ class task_menu : public stl_task
 		uint16_t button_adc;
 		int8_t button_press;
 		int8_t button_pressprev;
+		time_stamp menuInterval;		///< Task interval to go back to after a low power run
+		uint16_t lcdIdle;				///< Button reads with nothing pressed in a low power run
+		bool lcdOn;						///< The LCD is showing
+		bool lowPowerMenu;				///< Buttons and LCD are being run for a low power run
 	
 };
 
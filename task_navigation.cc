@@ -8,6 +8,9 @@
  *   -------------------------------STATES DEFINITION----------------------------------
  *   State 0 = Initialize
  *   State 1 = Calculate Period and compare to lower and upper limit. If inside the limit then change v_found to true.
+ *   State 9 = E-Stop fault, everything stays off until it is cleared from the menu.
+ *   State 10 = Plan pano grid, State 11 = Move to pano frame, State 12 = Pano settle,
+ *   State 13 = Pano take pic, State 14/15 = Pano pic delay, State 16 = Pano return to centre.
  *
  *
  *
@@ -41,6 +44,10 @@
 #include "lcdmenu1.h"			//custom library for creating menu system - part of micromenu
 #include "menu.h"				//custom library for creating menu system - part of micro menu
 #include "intervelometer.h"		//custom library for intervelometer 
+#include "pan_stepper.h"		//custom library for the pan axis stepper
+#include "fixed_point.h"		//custom library for integer math used by the planner
+#include "estop.h"				//custom library for the emergency stop input
+#include "ramp.h"				//custom library for exposure ramps
 #include "task_navigation.h"   		//.h file for this task menu class. <this class>
 
 
@@ -54,6 +61,21 @@
 #define RSTOP_SENSOR_PIN		PINC		//Pin for reading state of the left stop sensor
 #define RSTOP_SENSOR_PIN_BIT	PINC6		//pin register for reading state of the left stop sensor
 
+//MCU supply current awake and in idle sleep at 16MHz and 5V, datasheet typicals. The
+//  rest of the board adds to both, so set these from a bench measurement if the
+//  estimate is to be trusted for battery sizing
+#define LP_ACTIVE_UA			14000UL		//awake, in uA
+#define LP_IDLE_UA				4000UL		//idle sleep, in uA
+
+//Navigation task interval in a low power run. With no moves it only has to start each
+//  frame on time; the shots themselves are timed by the Timer 5 sequencer, so this
+//  only adds up to this much to when a frame starts
+#define LP_NAV_INTERVAL_US		10000L
+
+//Most frames the plan's end moves inside the exposure ramp each time it is brought up
+//  to date, which bounds the time state 8 takes however long the ramp is
+#define PLAN_STEPS				4
+
 //-------------------------------------------------------------------------------------
      /** This constructor creates a victim detection task object. The victim detection object needs pointers to
      *  an A/D converter, a serial port , time-stamp and task_timer.  This object takes a binary signal from 
@@ -66,9 +88,13 @@
      *  @param p_ser	A pointer to a serial port for sending messages (default NULL)
      *  @param p_timer	A pointer to task_timer for capturing current time and calculating period.
 	 *  @param p_adc_t	A pointer to adc converter.
+	 *  @param p_stepper_t	A pointer to the slide stepper.
+	 *  @param p_intervelometer_t	A pointer to the intervelometer.
+	 *  @param p_pan_t	A pointer to the pan axis stepper.
+	 *  @param p_estop_t	A pointer to the emergency stop input.
      */
 
-task_navigation::task_navigation (time_stamp* t_stamp, base_text_serial* p_ser, task_timer* p_timer, avr_adc* p_adc_t, stepper* p_stepper_t, intervelometer* p_intervelometer_t)
+task_navigation::task_navigation (time_stamp* t_stamp, base_text_serial* p_ser, task_timer* p_timer, avr_adc* p_adc_t, stepper* p_stepper_t, intervelometer* p_intervelometer_t, pan_stepper* p_pan_t, estop* p_estop_t)
 	: stl_task (*t_stamp, p_ser)
 {
 	
@@ -79,10 +105,588 @@ task_navigation::task_navigation (time_stamp* t_stamp, base_text_serial* p_ser,
 	p_adc = p_adc_t;			//ADC
     p_stepper = p_stepper_t;	//stepper motor
 	p_intervelometer = p_intervelometer_t;	//intervelometer
+	p_pan = p_pan_t;			//pan axis stepper
+	p_estop = p_estop_t;		//emergency stop input
+	
+	estopReported = false;
+	panoActive = false;
+	bracketShot = 0;
+	framePeriod = 0;
     
 }
 
 
+//-------------------------------------------------------------------------------------
+/** This method works out how long a slide move takes at a given Timer 4 count.
+ *  @param move_steps	Number of steps in the move
+ *  @param timer_count	Timer 4 count the move is made at (see state 1)
+ *  @return Move time in milliseconds
+ */
+
+unsigned long task_navigation::move_time_ms (unsigned int move_steps, unsigned int timer_count)
+{
+	unsigned long step_rate = (F_CPU / 256) / ((unsigned long)timer_count + 1);
+
+	if (step_rate == 0)
+	{
+		step_rate = 1;
+	}
+
+	return ((unsigned long)move_steps * 1000) / step_rate;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out how long to wait after a move before the next picture. The
+ *	rig is treated as a damped spring: stopping the carriage leaves a wobble whose size
+ *	goes with the speed it was moving at, and which dies out as exp(-t/tau). A move
+ *	shorter than the rig's natural period doesn't have time to wind the wobble up fully,
+ *	so its speed is scaled down by move time / rig period. The dwell is the time for
+ *	that wobble to drop to the tolerance, plus a fixed minimum:
+ *		settle = min + tau * ln(speed / tolerance)
+ *	The constants come from the menu EEPROM (GetSettleMin(), GetSettleTau(),
+ *	GetRigPeriod() and GetSettleTol()).
+ *  @param move_steps	Number of steps in the move that just finished
+ *  @param timer_count	Timer 4 count the move was made at (see state 1)
+ *  @return Settle dwell in milliseconds
+ */
+
+unsigned int task_navigation::settle_time_ms (unsigned int move_steps, unsigned int timer_count)
+{
+	unsigned long step_rate;		//peak speed of the move in steps/s
+	unsigned long move_ms;			//how long the move took
+	unsigned long excitation;		//speed scaled down for short moves
+	unsigned long ln_q8;			//ln(excitation / tolerance) in Q8
+	unsigned long settle;
+
+	if ((move_steps == 0) || (GetSettleTol() == 0))
+	{
+		return GetSettleMin();
+	}
+
+	step_rate = (F_CPU / 256) / ((unsigned long)timer_count + 1);
+	if (step_rate == 0)
+	{
+		step_rate = 1;
+	}
+
+	move_ms = move_time_ms (move_steps, timer_count);
+
+	excitation = step_rate;
+	if (move_ms < GetRigPeriod())
+	{
+		excitation = (step_rate * move_ms) / GetRigPeriod();
+	}
+
+	if (excitation <= GetSettleTol())
+	{
+		return GetSettleMin();
+	}
+
+	ln_q8 = fx_log2_q8(excitation) - fx_log2_q8(GetSettleTol());
+	ln_q8 = (ln_q8 * FX_LN2_Q8) >> 8;
+
+	settle = GetSettleMin() + ((GetSettleTau() * ln_q8) >> 8);
+	if (settle > 0xFFFF)
+	{
+		settle = 0xFFFF;
+	}
+
+	return (unsigned int)settle;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out the pan position that keeps the subject centred when the
+ *	carriage is a given number of steps along the track. The subject sits GetSubjectDist()
+ *	mm in front of the track, GetSubjectPos() mm from where the run starts, so the pan
+ *	angle is atan(sideways offset / distance). The angle comes from the fixed point table
+ *	in fixed_point.cc and is turned into pan steps, so a frame costs a few integer
+ *	divisions and no floating point.
+ *  @param slide_steps	Carriage position in steps from the start of the run
+ *  @return Pan axis target in steps, 0 being square to the track
+ */
+
+long task_navigation::pan_track_target (unsigned long slide_steps)
+{
+	long slide_um;				//carriage position in um
+	long offset_um;				//subject position relative to the carriage
+	int16_t angle;				//pan angle in binary angle units
+
+	//pitch is in um per tooth, so one step is pitch * teeth / stepsPerRev um
+	slide_um = (long)(((slide_steps * GetPitch()) / GetStepsPerRev()) * GetTeeth());
+	offset_um = (long)GetSubjectPos() * 1000 - slide_um;
+
+	angle = fx_atan2_bam(offset_um, (long)GetSubjectDist() * 1000);
+
+	return ((long)angle * (long)GetPanStepsPerRev()) / 65536L;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method writes the average current of the frame just finished in a low power
+ *	run. There is no current sense on the board, so it is worked out from how long
+ *	the processor was awake against asleep and the LP_ currents above. The main loop's
+ *	awake time is measured with the task timer; the interrupts which wake it in
+ *	between (the 1kHz sequencer tick, mostly) are counted and given WAKE_US each in
+ *	timescape.cc. The count starts again for the next frame.
+ */
+
+void task_navigation::report_power (void)
+{
+	unsigned long now = p_intervelometer->time_ms();
+	unsigned long frame_ms = now - lastFrameTime;
+	unsigned long awake_ms = awake_us / 1000;
+	unsigned long duty;								//awake time in tenths of a percent
+
+	if ((currentPicNumber > 0) && (frame_ms > 0))
+	{
+		if (awake_ms > frame_ms)
+		{
+			awake_ms = frame_ms;
+		}
+		duty = (awake_ms < 4000000UL) ? (awake_ms * 1000) / frame_ms : (awake_ms / (frame_ms / 1000));
+		
+		*p_serial <<endl <<"Frame " <<(currentPicNumber - 1) <<" awake " <<awake_ms <<"ms of " <<frame_ms
+			<<"ms, about " <<(LP_IDLE_UA + ((LP_ACTIVE_UA - LP_IDLE_UA) * duty) / 1000) <<"uA";
+	}
+	
+	awake_us = 0;
+	lastFrameTime = now;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method hands the camera settings in the menu to the intervelometer. It is
+ *	called once as a run starts rather than on every pass while waiting for input,
+ *	since setting up the sync input writes registers the Timer 5 ISR shares.
+ */
+
+void task_navigation::camera_setup (void)
+{
+	p_intervelometer->SetFocus(GetFocusLead(), GetFocusHold());
+	p_intervelometer->SetSyncInput(GetSyncInput());
+	p_intervelometer->SetCameraB(GetCamBExposure(), GetCamBOffset());
+	p_intervelometer->SetIrRemote(GetIrRemote());
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method writes the time stamp of the last sync input edge to the serial port,
+ *	so the camera's real busy time can be seen and the pic delay trimmed to suit.
+ */
+
+void task_navigation::log_sync (void)
+{
+	unsigned char phase;
+	unsigned long ms;
+	uint16_t ticks;
+	uint8_t sreg = SREG;		//save current interrupt flag
+
+	cli();
+	phase = sync_phase;
+	ms = sync_ms;
+	ticks = sync_ticks;
+	sync_captured = false;
+	SREG = sreg;
+
+	*p_serial <<endl <<"Sync edge " <<ms <<"ms " <<(ticks * 4) <<"us into ";
+	if (phase == SYNC_PHASE_EXPOSURE)
+	{
+		*p_serial <<"exposure";
+	}
+	else if (phase == SYNC_PHASE_PIC_DELAY)
+	{
+		*p_serial <<"pic delay, ended it";
+	}
+	else
+	{
+		*p_serial <<"idle";
+	}
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out the exposure for one shot of an HDR bracket. The shots go
+ *	from darkest to brightest, spread evenly in stops either side of the frame's
+ *	exposure, GetBracketStep() thirds of a stop apart.
+ *  @param base		Exposure for the frame, from the ramp, in ms
+ *  @param shot		Shot number in the bracket, from 0
+ *  @return Exposure for that shot in ms, never less than 1
+ */
+
+unsigned long task_navigation::bracket_exposure (unsigned long base, unsigned char shot)
+{
+	int32_t stops;				//offset from the base exposure in stops, Q16.16
+	unsigned long exposure;
+
+	if (GetBracketShots() <= 1)
+	{
+		return base;
+	}
+
+	//(2 * shot - (shots - 1)) half steps, and a step is GetBracketStep() / 3 stops
+	stops = (int32_t)(2 * shot - (GetBracketShots() - 1)) * GetBracketStep();
+	stops = (stops * 65536L) / 6;
+
+	exposure = fx_scale_pow2 (base, stops);
+	return (exposure > 0) ? exposure : 1;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out how long a frame takes, not counting the move: every shot of
+ *	the bracket with its focus lead, and the pic delay between shots. After the last
+ *	shot the pic delay runs alongside the motor delay, move and settle, so only the
+ *	longer of the two counts. The move itself is left out since all the moves add up to
+ *	totalTravelTime whatever the frame count. A shot lasts until both cameras have
+ *	closed.
+ *  @param frame	Frame number, for the exposure ramp
+ *  @return Frame time in ms
+ */
+
+unsigned long task_navigation::frame_time_ms (unsigned int frame)
+{
+	return shots_time_ms (frame) + after_time_ms ();
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out the part of a frame's time that changes with the exposure
+ *	ramp: the bracket shots with their focus leads and the pic delays between them.
+ *  @param frame	Frame number, for the exposure ramp
+ *  @return Shots time in ms
+ */
+
+unsigned long task_navigation::shots_time_ms (unsigned int frame)
+{
+	unsigned long base = exposureRamp.value (frame);
+	unsigned long total = 0;
+	unsigned long shot_ms;				//one shot, until the last camera closes
+	unsigned long cam_b_ms = 0;			//second camera's offset plus exposure
+
+	//the second camera can still be open after the first one has closed
+	if (GetCamBExposure() > 0)
+	{
+		cam_b_ms = GetCamBOffset() + GetCamBExposure();
+	}
+
+	for (unsigned char shot = 0; shot < GetBracketShots(); shot++)
+	{
+		shot_ms = bracket_exposure (base, shot);
+		if (cam_b_ms > shot_ms)
+		{
+			shot_ms = cam_b_ms;
+		}
+		total += shot_ms + GetFocusLead();
+		if (shot + 1 < GetBracketShots())
+		{
+			total += GetPicDelay();
+		}
+	}
+
+	return total;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method works out the part of a frame's time after the last shot, less the
+ *	move: the longer of the pic delay and the motor delay, move and settle. It is the
+ *	same for every frame until the move or settle dwell changes.
+ *  @return Time after the shots in ms
+ */
+
+unsigned long task_navigation::after_time_ms (void)
+{
+	unsigned long move_ms = move_time_ms (stepsPerPic, timerCount);
+	unsigned long after_ms;				//from the last shot closing to the next frame
+
+	after_ms = (unsigned long)GetMotorDelay() + move_ms + settleTime;
+	if (after_ms < GetPicDelay())
+	{
+		after_ms = GetPicDelay();
+	}
+
+	return after_ms - move_ms;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method counts how many frames fit in a time budget, starting at a given frame.
+ *	With an exposure ramp every frame inside the ramp has its own length so they are
+ *	added up one at a time; past the end of the ramp they are all the same and a
+ *	division does the rest. The frames counted become the plan replan_frames() keeps
+ *	up to date during the run.
+ *  @param first		Frame to start counting at
+ *  @param budget_ms	Time left for frames, in ms
+ *  @return Number of frames that fit
+ */
+
+unsigned int task_navigation::plan_frames (unsigned int first, unsigned long budget_ms)
+{
+	unsigned long shots_ms;
+	unsigned long after_ms = after_time_ms ();
+	unsigned long frames = 0;
+	unsigned long more;
+	unsigned int frame = first;
+
+	planShotsMs = 0;
+	while (frame < exposureRamp.end_frame())
+	{
+		shots_ms = shots_time_ms (frame);
+		if (shots_ms + after_ms > budget_ms)
+		{
+			planEnd = frame;
+			return (unsigned int)frames;
+		}
+		budget_ms -= shots_ms + after_ms;
+		planShotsMs += shots_ms;
+		frames++;
+		frame++;
+	}
+
+	shots_ms = shots_time_ms (frame);
+	more = budget_ms / (shots_ms + after_ms);
+	if (frames + more > 0xFFFF - first)
+	{
+		more = 0xFFFF - first - frames;
+	}
+	frames += more;
+	planShotsMs += more * shots_ms;
+	planEnd = first + frames;
+
+	return (unsigned int)frames;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method brings the frame plan back in line with the time left after the frames
+ *	shot so far and the settle dwell have changed, without adding the whole plan up
+ *	again. The shots time of the frames left is kept as a running total, taken off as
+ *	each frame is shot, so the plan only has to move its end: frames are dropped while
+ *	the plan overruns the time left and added while another one fits. Inside the ramp
+ *	that is one frame at a time, at most PLAN_STEPS a call, so a run costs the same
+ *	however long the ramp is; past the end of the ramp the frames are all the same and
+ *	a division moves the end as far as it needs to go.
+ *  @param budget_ms	Time left for frames, in ms
+ *  @return Number of frames left in the plan
+ */
+
+unsigned int task_navigation::replan_frames (unsigned long budget_ms)
+{
+	unsigned long after_ms = after_time_ms ();
+	unsigned long shots_ms;
+	unsigned long frames_left;
+	unsigned long need;					//time the frames left in the plan take
+	unsigned long step;
+	unsigned int ramp_end = exposureRamp.end_frame();
+
+	if (planEnd < currentPicNumber)
+	{
+		planEnd = currentPicNumber;
+		planShotsMs = 0;
+	}
+	frames_left = planEnd - currentPicNumber;
+	need = planShotsMs + frames_left * after_ms;
+
+	for (unsigned char pass = 0; (pass < PLAN_STEPS) && (need > budget_ms) && (frames_left > 0); pass++)
+	{
+		shots_ms = shots_time_ms (planEnd - 1);
+		step = 1;
+		if (planEnd - 1 >= ramp_end)
+		{
+			//drop as many of the same frames past the ramp as it takes
+			step = (need - budget_ms + shots_ms + after_ms - 1) / (shots_ms + after_ms);
+			if (step > planEnd - ((ramp_end > currentPicNumber) ? ramp_end : currentPicNumber))
+			{
+				step = planEnd - ((ramp_end > currentPicNumber) ? ramp_end : currentPicNumber);
+			}
+		}
+		planEnd -= step;
+		frames_left -= step;
+		planShotsMs = (planShotsMs > step * shots_ms) ? planShotsMs - step * shots_ms : 0;
+		need = planShotsMs + frames_left * after_ms;
+	}
+
+	for (unsigned char pass = 0; (pass < PLAN_STEPS) && (planEnd < 0xFFFF); pass++)
+	{
+		shots_ms = shots_time_ms (planEnd);
+		if (need + shots_ms + after_ms > budget_ms)
+		{
+			break;
+		}
+		step = 1;
+		if (planEnd >= ramp_end)
+		{
+			//add as many of the same frames past the ramp as fit
+			step = (budget_ms - need) / (shots_ms + after_ms);
+			if (step > 0xFFFFUL - planEnd)
+			{
+				step = 0xFFFFUL - planEnd;
+			}
+		}
+		planEnd += step;
+		frames_left += step;
+		planShotsMs += step * shots_ms;
+		need = planShotsMs + frames_left * after_ms;
+	}
+
+	return (unsigned int)frames_left;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method counts how many frames fit in a run on the fixed frame period grid.
+ *	With an interval ramp the period of each frame inside the ramp is added up one at
+ *	a time, which integrates the interval curve; past the end of the ramp the period
+ *	is constant and a division does the rest.
+ *  @param run_ms	Length of the run, in ms
+ *  @return Number of frames that fit, at least 1
+ */
+
+unsigned int task_navigation::plan_grid_frames (unsigned long run_ms)
+{
+	unsigned long period;
+	unsigned long frames = 0;
+
+	while (frames < intervalRamp.end_frame())
+	{
+		period = intervalRamp.value (frames);
+		if (period > run_ms)
+		{
+			break;
+		}
+		run_ms -= period;
+		frames++;
+	}
+
+	if (frames >= intervalRamp.end_frame())
+	{
+		frames += run_ms / intervalRamp.value (frames);
+	}
+
+	if (frames > 0xFFFF)
+	{
+		frames = 0xFFFF;
+	}
+
+	return (frames == 0) ? 1 : (unsigned int)frames;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method starts the moves to one frame of the pano grid. Frames are taken row
+ *	by row with every other row run backwards (serpentine), so each move is one column
+ *	across or one row up and the pan axis never flies back across the whole row. The
+ *	target is worked out from the grid origin rather than added to the last move so
+ *	rounding doesn't build up. Columns are on the pan axis; rows are on the tilt motor,
+ *	which is driven from the slide stepper output without the slide's resonance bands.
+ *	The tilt position is read back from the steps the output has actually made, so a
+ *	move cut short by an e-stop still leaves it right.
+ *  @param frame	Frame number, 0 being the first frame of the first row
+ *  @return The longer of the two moves in steps, for working out the settle dwell
+ */
+
+unsigned long task_navigation::pano_move_to_frame (unsigned int frame)
+{
+	unsigned char row = frame / GetPanoCols();
+	unsigned char col = frame % GetPanoCols();
+	long pan_target;
+	long tilt_target;
+	long tilt_position = p_stepper->get_position() - tiltZero;
+	unsigned long pan_move;
+	unsigned long tilt_move;
+
+	//odd rows run right to left
+	if (row & 1)
+	{
+		col = GetPanoCols() - 1 - col;
+	}
+
+	pan_target = panoPanOrigin + (long)col * panoColSteps;
+	tilt_target = panoTiltOrigin + (long)row * panoRowSteps;
+
+	pan_move = labs (pan_target - pan_position);
+	tilt_move = labs (tilt_target - tilt_position);
+
+	p_pan->move_to (pan_target, panTimerCount);
+
+	//step() never finishes a move of 0 steps, so only move the tilt if it has to
+	if (tilt_move > 0)
+	{
+		inMoveMotorMode = true;
+		p_stepper->step_exact ((tilt_target > tilt_position), tilt_move, panTimerCount);
+	}
+
+	return (pan_move > tilt_move) ? pan_move : tilt_move;
+}
+
+
+//-------------------------------------------------------------------------------------
+/** This method keeps frames on a fixed grid, framePeriod apart or following the
+ *	interval ramp. The first call for a
+ *	frame records how much time was left to spare (the slack); a frame that gets here
+ *	after its grid time is an overrun. A frame more than a whole period late moves the
+ *	grid instead of firing a burst of frames to catch up.
+ *  @return True when the frame should start now
+ */
+
+bool task_navigation::frame_due (void)
+{
+	unsigned long now;
+	unsigned long period;			//time from this frame to the next, in ms
+	long late;						//ms past the grid time, negative while early
+
+	if (framePeriod == 0)
+	{
+		return true;
+	}
+
+	now = p_intervelometer->time_ms();
+	late = (long)(now - nextFrameTime);
+
+	if (late < 0)
+	{
+		if (frameWaiting == false)
+		{
+			frameWaiting = true;
+			if ((unsigned long)(-late) < minSlack)
+			{
+				minSlack = -late;
+			}
+		}
+		return false;
+	}
+
+	if (frameWaiting == false)
+	{
+		minSlack = 0;
+		if (late > 0)
+		{
+			overrunCount++;
+			if ((unsigned long)late > overrunMax)
+			{
+				overrunMax = late;
+			}
+			*p_serial <<endl <<"Frame " <<currentPicNumber <<" late by " <<(unsigned long)late <<"ms";
+		}
+	}
+
+	frameWaiting = false;
+	period = intervalRamp.value (currentPicNumber);
+	if ((unsigned long)late >= period)
+	{
+		nextFrameTime = now + period;
+	}
+	else
+	{
+		nextFrameTime += period;
+	}
+
+	return true;
+}
+
+
 //-------------------------------------------------------------------------------------
 /** This is the function which runs when it is called by the task scheduler. It causes
  *  navigation task sto run.
@@ -93,7 +697,17 @@ task_navigation::task_navigation (time_stamp* t_stamp, base_text_serial* p_ser,
 
 char task_navigation::run (char state)
 {
+	//The e-stop ISR has already stopped everything, this makes sure nothing starts
+	//  again until the fault is cleared
+	if ((p_estop->is_latched()) && (state != 9))
+	{
+		return (9);
+	}
 	
+	if (sync_captured == true)
+	{
+		log_sync();
+	}
 
 	switch (state)
 	{
@@ -105,6 +719,7 @@ char task_navigation::run (char state)
 			//initilization
 			
 			p_stepper->stop();
+			p_pan->stop();
 			//variables
 			// init_left = false;
 			// init_right = false;
@@ -115,6 +730,7 @@ char task_navigation::run (char state)
 			totalNumberOfPics = 0;
 			stepsPerPic = 0;
 			currentPicNumber = 0;
+			bracketShot = 0;
 	
 			//Set Right stop sensor to input.
 			//DDRC &= ~(1<<DDC6);
@@ -134,11 +750,30 @@ char task_navigation::run (char state)
 		// State 1: Waiting for User Input
 		case (1):
 		{
+			unsigned int pan_speed;
+			
 			//*p_serial <<endl << "nav case 1: Waiting..";
 			//*p_serial <<endl << "init_left: " << init_left;
 			//*p_serial <<endl << "init_right: " << init_right;
 			
 			p_stepper->stop();
+			if (pan_tracking)
+			{
+				p_pan->stop();
+			}
+			
+			//a low power run is over, the task menu turns the LCD back on
+			if (lowPowerRun)
+			{
+				lowPowerRun = 0;
+				p_stepper->clock_on();
+				set_interval (runInterval);
+			}
+			
+			//Step rates the slide resonates at, step() steers every move around them.
+			//  Loaded here so bands edited in the menu count from the next run
+			p_stepper->set_resonance_band(0, GetResonanceLo(0), GetResonanceHi(0));
+			p_stepper->set_resonance_band(1, GetResonanceLo(1), GetResonanceHi(1));
 			
 			//Get the timerCount so we know how fast to move motor based on RPM.
 			
@@ -147,8 +782,25 @@ char task_navigation::run (char state)
 			num = F_CPU * 60;
 			timerCount = num/den;
 			
+			//step() would move this out of a resonance band anyway, but the planner
+			//  needs to know the speed the moves will really run at
+			timerCount = p_stepper->avoid_resonance(timerCount);
+			
 			//timerCount = (F_CPU * 60) / (256 * GetMotorRPM() * GetStepsPerRev());
 			
+			//Pan moves are short, so they just run at a fixed step rate. The EEPROM can
+			//  hold anything, so the rate is kept to what Timer 1 can step at
+			pan_speed = GetPanSpeed();
+			if (pan_speed < PAN_SPEED_MIN)
+			{
+				pan_speed = PAN_SPEED_MIN;
+			}
+			else if (pan_speed > PAN_SPEED_MAX)
+			{
+				pan_speed = PAN_SPEED_MAX;
+			}
+			panTimerCount = (F_CPU / 256) / pan_speed - 1;
+			
 			//*p_serial <<endl << "Num: " <<num;
 			//*p_serial <<endl << "Den: " <<den;
 			//*p_serial <<endl << "timer: " <<timerCount;
@@ -169,9 +821,15 @@ char task_navigation::run (char state)
 			
 			if (startTimelapse == 1) 
 			{
-				
+				camera_setup();
 				return(4);
 			}
+			
+			if (startPano == 1)
+			{
+				camera_setup();
+				return(10);
+			}
 				
 			else {
 				
@@ -292,16 +950,87 @@ char task_navigation::run (char state)
 				
 				totalTravelTime = num/den;
 				//totalTravelTime = (60*GetTrackLength()*1000) / (GetPitch() * GetTeeth() * GetMotorRPM());
+				
+				//Low power runs are intervelometer only, the carriage stays put
+				if (GetLowPower())
+				{
+					totalSteps = 0;
+					totalTravelTime = 0;
+				}
 				*p_serial <<endl << "Total Travel Time = " <<totalTravelTime;
 				
 				//-----------------------------------------------
-				//num = 
-				totalNumberOfPics = (60*GetTimelapsePeriod() - totalTravelTime) / (GetShutterSpeed() + GetPicDelay() + 2 * GetMotorDelay());
-				*p_serial <<endl << "Total Number of Pics = " <<totalNumberOfPics;
+				//Exposure for each frame, a flat line unless a ramp is set up
+				exposureRamp.set (GetShutterSpeed(), GetRampEnd(), GetRampCurve(), GetRampFirst(), GetRampLast());
 				
-				//-----------------------------------------------
-				stepsPerPic = totalSteps / totalNumberOfPics;
+				//Time for frames in ms, the moves come out of the period first
+				frameBudget = GetTimelapsePeriod();
+				frameBudget = frameBudget * 60 * 1000;
+				num = (unsigned long)totalTravelTime * 1000;
+				frameBudget = (frameBudget > num) ? (frameBudget - num) : 0;
+				frameTimeUsed = 0;
+				stepsDone = 0;
+				
+				framePeriod = GetFramePeriod();
+				overrunCount = 0;
+				overrunMax = 0;
+				minSlack = 0xFFFFFFFF;
+				
+				if (framePeriod > 0)
+				{
+					//Fixed frame period: the frame count is set by the grid, and
+					//  each frame has to fit its shots, delays, move and settle in it.
+					//  The moves are the same length every frame, so the carriage
+					//  still covers the whole track however the interval ramps.
+					intervalRamp.set (framePeriod, GetIntervalEnd(), GetIntervalCurve(), GetRampFirst(), GetRampLast());
+					num = GetTimelapsePeriod();
+					totalNumberOfPics = plan_grid_frames (num * 60 * 1000);
+					stepsPerPic = totalSteps / totalNumberOfPics;
+					settleTime = settle_time_ms (stepsPerPic, timerCount);
+					
+					//ramps only ever run one way, so the tightest frame is at one end
+					*p_serial <<endl << "Frame Period (ms) = " <<framePeriod <<" to " <<intervalRamp.value (totalNumberOfPics - 1);
+					for (unsigned char end = 0; end < 2; end++)
+					{
+						unsigned int frame = (end == 0) ? 0 : totalNumberOfPics - 1;
+						
+						num = frame_time_ms (frame) + move_time_ms (stepsPerPic, timerCount);
+						if (num > intervalRamp.value (frame))
+						{
+							*p_serial <<endl << "Frame " <<frame <<" needs " <<num <<"ms, expect overruns";
+						}
+					}
+				}
+				else
+				{
+					//The settle dwell depends on the move length, so start with the dwell
+					//  for a full speed move and refine it once we know how far each frame
+					//  moves.
+					settleTime = settle_time_ms (totalSteps, timerCount);
+					for (unsigned char pass = 0; pass < 2; pass++)
+					{
+						totalNumberOfPics = plan_frames (0, frameBudget);
+						if (totalNumberOfPics == 0)
+						{
+							totalNumberOfPics = 1;
+						}
+						
+						stepsPerPic = totalSteps / totalNumberOfPics;
+						settleTime = settle_time_ms (stepsPerPic, timerCount);
+					}
+				}
+				*p_serial <<endl << "Total Number of Pics = " <<totalNumberOfPics;
 				*p_serial <<endl << "Steps Per Pic = " <<stepsPerPic;
+				*p_serial <<endl << "Settle Time (ms) = " <<settleTime;
+				
+				//The user points the pan axis at the subject before starting, so that is
+				//  where the tracking angle for the first frame is
+				if (GetPanMode() == PAN_MODE_TRACK)
+				{
+					panStartTarget = pan_track_target (0);
+					p_pan->set_position (panStartTarget);
+					*p_serial <<endl << "Pan Start = " <<panStartTarget;
+				}
 			
 			}
 			
@@ -309,6 +1038,34 @@ char task_navigation::run (char state)
 			if ((startTimelapse == 1) && (currentPicNumber <= totalNumberOfPics))
 			{
 				lastPicNumber = 0;
+				
+				//the frame grid starts now
+				nextFrameTime = p_intervelometer->time_ms();
+				frameWaiting = false;
+				
+				//Low power runs don't touch the motors at all. The task menu only turns
+				//  the ADC on to look at the buttons and main() sleeps between ticks
+				if (GetLowPower())
+				{
+					p_stepper->clock_off();
+					p_pan->stop();
+					awake_us = 0;
+					lastFrameTime = nextFrameTime;
+					lowPowerRun = 1;
+					
+					//this task only looks in now and then, so the processor can sleep
+					//  from one sequencer tick to the next
+					runInterval = interval;
+					set_interval (time_stamp (0, LP_NAV_INTERVAL_US));
+					*p_serial <<endl << "Low power run, no moves";
+				}
+				
+				//The sky turns through the whole run, moves or not. The slide still
+				//  moves between frames as set, so it can creep along underneath
+				else if (GetPanMode() == PAN_MODE_SIDEREAL)
+				{
+					p_pan->track ((GetSunLat() >= 0), GetPanStepsPerRev());
+				}
 				return(5);
 			}
 			
@@ -333,6 +1090,12 @@ char task_navigation::run (char state)
 		{  
 			if (currentPicNumber >= totalNumberOfPics)
 			{
+				if (framePeriod > 0)
+				{
+					*p_serial <<endl <<"Frames late = " <<overrunCount <<", worst = " <<overrunMax <<"ms";
+					*p_serial <<endl <<"Least slack = " <<((minSlack == 0xFFFFFFFF) ? 0 : minSlack) <<"ms";
+				}
+				
 				//go back to waiting status.
 				*p_serial <<endl <<"going back to waiting status";
 				startTimelapse = 0;
@@ -345,14 +1108,50 @@ char task_navigation::run (char state)
 				//go back to waiting status.
 				return(1);
 			}
+			
+			else if ((inMotorDelayMode == true) || (inPicDelayMode == true))
+			{
+				//still settling after the last move, or the camera is still busy
+				//  with the last shot of a bracket
+				return (STL_NO_TRANSITION);
+			}
+			
+			else if ((bracketShot == 0) && (frame_due() == false))
+			{
+				//waiting for this frame's slot on the fixed frame period grid
+				return (STL_NO_TRANSITION);
+			}
 
 			else 
 			{
-				*p_serial <<endl <<"Taking Pic and going to PicDelayMode";
-				inTakePicMode = true;
-				p_intervelometer->SetTimelapse(GetShutterSpeed());
+				num = bracket_exposure (exposureRamp.value (currentPicNumber), bracketShot);
+				if (lowPowerRun && (bracketShot == 0))
+				{
+					report_power();
+				}
+				*p_serial <<endl <<"Taking " <<num <<"ms Pic and going to PicDelayMode";
+				p_intervelometer->SetTimelapse(num);
+				p_intervelometer->SetFrame(currentPicNumber);
 				p_intervelometer->take_pic();
-				currentPicNumber++;
+				
+				if (bracketShot == 0)
+				{
+					//this frame comes out of the plan's running total
+					den = shots_time_ms (currentPicNumber);
+					frameTimeUsed += den + after_time_ms ();
+					if (currentPicNumber < planEnd)
+					{
+						planShotsMs = (planShotsMs > den) ? planShotsMs - den : 0;
+					}
+				}
+				
+				//the carriage only moves on once the whole bracket is taken
+				bracketShot++;
+				if (bracketShot >= GetBracketShots())
+				{
+					bracketShot = 0;
+					currentPicNumber++;
+				}
 				return (6);
 			}
 		
@@ -364,10 +1163,16 @@ char task_navigation::run (char state)
 		{
 			if (inTakePicMode == false) 
 			{
-				*p_serial <<endl <<"Starting Pic Delay and going to MotorDelayMode";
-				inPicDelayMode = true;
+				*p_serial <<endl <<"Starting Pic Delay and going to MotorDelayMode alongside it";
 				p_intervelometer->SetPicDelay(GetPicDelay());
 				p_intervelometer->delay_loop();
+				
+				//more shots in this bracket, state 5 waits out the pic delay. Low
+				//  power runs have no moves, so the next frame just waits for its slot
+				if ((bracketShot != 0) || lowPowerRun)
+				{
+					return(5);
+				}
 				return(7);
 			}
 			
@@ -387,24 +1192,32 @@ char task_navigation::run (char state)
 			break;
 		}
 		
-		//State 7: Motor Move Delay
+		//State 7: Motor Move Delay. The camera's pic delay keeps running while the
+		//  carriage moves and settles; state 5 waits for both before the next shot
 		case (7):
 		{
-			if ((inMoveMotorMode == false) && (inPicDelayMode == false) && (motorMoveComplete == true))
+			if ((inMoveMotorMode == false) && (inPanMoveMode == false) && (motorMoveComplete == true))
 			{
-				*p_serial <<endl <<"Starting Motor Delay and going to TakePicMode";
-				p_intervelometer->SetMotorDelay(GetMotorDelay());
-				p_intervelometer->delay_loop();
+				//Settle dwell worked out from the move that just finished
+				settleTime = settle_time_ms (stepsPerPic, timerCount);
+				*p_serial <<endl <<"Starting Settle Delay of " <<settleTime <<"ms and going to TakePicMode";
+				if (settleTime > 0)
+				{
+					p_intervelometer->SetMotorDelay(settleTime);
+					p_intervelometer->settle_loop();
+				}
 				motorMoveComplete = false;
 				return(5);
 			}
 			
-			else if ((inMoveMotorMode == false) && (inPicDelayMode == false) && (motorMoveComplete == false))
+			else if ((inMoveMotorMode == false) && (motorMoveComplete == false))
 			{
 				*p_serial <<endl <<"Starting Motor Delay and going to MoveMotorMode";
-				inMotorDelayMode = true;
-				p_intervelometer->SetMotorDelay(GetMotorDelay());
-				p_intervelometer->delay_loop();
+				if (GetMotorDelay() > 0)
+				{
+					p_intervelometer->SetMotorDelay(GetMotorDelay());
+					p_intervelometer->settle_loop();
+				}
 				return(8);
 			}
 			
@@ -428,9 +1241,51 @@ char task_navigation::run (char state)
 		{
 			if (inMotorDelayMode == false)	
 			{	
+				unsigned int framesLeft;
+				
+				if (framePeriod > 0)
+				{
+					//the grid fixes the frame count
+					framesLeft = totalNumberOfPics - currentPicNumber;
+				}
+				else
+				{
+					//As a ramp makes the frames longer fewer of them fit, so bring the
+					//  plan up to date and spread the rest of the track over it
+					num = (frameBudget > frameTimeUsed) ? (frameBudget - frameTimeUsed) : 0;
+					framesLeft = replan_frames (num);
+					totalNumberOfPics = currentPicNumber + framesLeft;
+				}
+				stepsPerPic = (stepsDone < totalSteps) ? (totalSteps - stepsDone) / ((unsigned long)framesLeft + 1) : 0;
+				
+				//Warn when the move and settle won't fit in what is left of this period
+				if ((framePeriod > 0) && (framesLeft > 0))
+				{
+					num = move_time_ms (stepsPerPic, timerCount) + settle_time_ms (stepsPerPic, timerCount);
+					den = nextFrameTime - p_intervelometer->time_ms();
+					if ((long)den < (long)num)
+					{
+						*p_serial <<endl <<"Move needs " <<num <<"ms, slack " <<(long)den <<"ms";
+					}
+				}
+				
 				*p_serial <<endl <<"Moving Motor and going to MotorDelayMode";	
-				inMoveMotorMode = true;
-				p_stepper->step(1, stepsPerPic, timerCount);
+				if (stepsPerPic > 0)
+				{
+					inMoveMotorMode = true;
+					p_stepper->step(1, stepsPerPic, timerCount);
+				}
+				else
+				{
+					motorMoveComplete = true;
+				}
+				stepsDone += stepsPerPic;
+				
+				//Turn the pan axis to where the subject will be after this move
+				if (GetPanMode() == PAN_MODE_TRACK)
+				{
+					p_pan->move_to (pan_track_target (stepsDone), panTimerCount);
+				}
 				return (7);
 			}
 			
@@ -450,6 +1305,191 @@ char task_navigation::run (char state)
 			break;
 		}
 		
+		//State 9: E-Stop fault
+		case (9):
+		{
+			if (estopReported == false)
+			{
+				*p_serial <<endl <<"E-STOP! Clear E-Stop under Initialize to continue";
+				estopReported = true;
+			}
+			
+			//keep everything off, the run is left where it stopped so Start TL resumes it
+			p_stepper->stop();
+			p_pan->stop();
+			p_intervelometer->stop_timer();
+			init_left = 0;
+			init_right = 0;
+			startTimelapse = 0;
+			inMoveMotorMode = false;
+			motorMoveComplete = false;
+			
+			if ((estop_clear == 1) && (p_estop->acknowledge()))
+			{
+				estop_clear = 0;
+				estopReported = false;
+				
+				//a pano that was cut short points the head back where it started first
+				if (panoActive)
+				{
+					return (16);
+				}
+				return (1);
+			}
+			
+			return (STL_NO_TRANSITION);
+			break;
+		}
+		
+		//State 10: Plan the pano grid around where the head is pointing now
+		case (10):
+		{
+			//step between frames is the field of view less the overlap
+			panoColSteps = ((unsigned long)GetPanStepsPerRev() * GetPanoHFov() * (100 - GetPanoOverlap())) / 36000UL;
+			panoRowSteps = ((unsigned long)GetTiltStepsPerRev() * GetPanoVFov() * (100 - GetPanoOverlap())) / 36000UL;
+			panoFrames = (unsigned int)GetPanoRows() * GetPanoCols();
+			
+			//centre the grid on the current position so the furthest frame is as close
+			//  as it can be
+			tiltZero = p_stepper->get_position();
+			panoActive = true;
+			panoPanOrigin = pan_position - (long)((GetPanoCols() - 1) * panoColSteps) / 2;
+			panoTiltOrigin = -(long)((GetPanoRows() - 1) * panoRowSteps) / 2;
+			panStartTarget = pan_position;
+			panoFrame = 0;
+			
+			*p_serial <<endl << "Pano Frames = " <<panoFrames;
+			*p_serial <<endl << "Pano Col Steps = " <<panoColSteps;
+			*p_serial <<endl << "Pano Row Steps = " <<panoRowSteps;
+			
+			return(11);
+			break;
+		}
+		
+		//State 11: Move to the next pano frame
+		case (11):
+		{
+			if (startPano == 0)
+			{
+				return(16);
+			}
+			
+			num = pano_move_to_frame (panoFrame);
+			if (num > 0xFFFF)
+			{
+				num = 0xFFFF;
+			}
+			settleTime = settle_time_ms ((unsigned int)num, panTimerCount);
+			return(12);
+			break;
+		}
+		
+		//State 12: Let the head settle once both axes have stopped
+		case (12):
+		{
+			if (startPano == 0)
+			{
+				return(16);
+			}
+			
+			if ((inPanMoveMode == false) && (inMoveMotorMode == false))
+			{
+				if (settleTime > 0)
+				{
+					p_intervelometer->SetMotorDelay(settleTime);
+					p_intervelometer->settle_loop();
+				}
+				return(13);
+			}
+			
+			return (STL_NO_TRANSITION);
+			break;
+		}
+		
+		//State 13: Pano take pic
+		case (13):
+		{
+			if (startPano == 0)
+			{
+				return(16);
+			}
+			
+			if (inMotorDelayMode == false)
+			{
+				*p_serial <<endl <<"Pano frame " <<(panoFrame + 1) <<" of " <<panoFrames;
+				p_intervelometer->SetTimelapse(GetShutterSpeed());
+				p_intervelometer->SetFrame(panoFrame);
+				p_intervelometer->take_pic();
+				return(14);
+			}
+			
+			return (STL_NO_TRANSITION);
+			break;
+		}
+		
+		//State 14: Pano pic delay, started once the shutter has closed
+		case (14):
+		{
+			if (inTakePicMode == false)
+			{
+				p_intervelometer->SetPicDelay(GetPicDelay());
+				p_intervelometer->delay_loop();
+				return(15);
+			}
+			
+			return (STL_NO_TRANSITION);
+			break;
+		}
+		
+		//State 15: Wait out the pic delay, then on to the next frame
+		case (15):
+		{
+			if (inPicDelayMode == true)
+			{
+				return (STL_NO_TRANSITION);
+			}
+			
+			panoFrame++;
+			if ((panoFrame >= panoFrames) || (startPano == 0))
+			{
+				return(16);
+			}
+			return(11);
+			break;
+		}
+		
+		//State 16: Pano done or stopped, point the head back where it started
+		case (16):
+		{
+			long tilt_position;
+			
+			if ((inPanMoveMode == true) || (inMoveMotorMode == true))
+			{
+				return (STL_NO_TRANSITION);
+			}
+			
+			tilt_position = p_stepper->get_position() - tiltZero;
+			if ((pan_position != panStartTarget) || (tilt_position != 0))
+			{
+				p_pan->move_to (panStartTarget, panTimerCount);
+				if (tilt_position != 0)
+				{
+					inMoveMotorMode = true;
+					p_stepper->step_exact ((tilt_position < 0), labs (tilt_position), panTimerCount);
+				}
+				return (STL_NO_TRANSITION);
+			}
+			
+			//the tilt moves set this in the Timer 4 ISR, it mustn't be left for the
+			//  timelapse's first slide move to find
+			motorMoveComplete = false;
+			panoActive = false;
+			*p_serial <<endl <<"Pano done";
+			startPano = 0;
+			return(1);
+			break;
+		}
+		
 		// If the state isn't a known state, call Houston; we have a problem
 		default:
 			STL_DEBUG ("WARNING: Menu System task in state " << state << endl);
@@ -25,6 +25,7 @@ extern volatile bool inPicDelayMode;
 extern volatile bool inMotorDelayMode;
 extern volatile bool inMoveMotorMode;
 extern volatile bool motorMoveComplete;
+extern unsigned long awake_us;			//microseconds spent awake, interrupt wakes included
 
 class task_navigation : public stl_task
 {
@@ -37,12 +38,61 @@ class task_navigation : public stl_task
 		avr_adc* p_adc;						///< Pointer to analog to digital converter class for reading menu navigation buttons.
 		stepper* p_stepper;					///< Pointer to stepper motor class.
 		intervelometer* p_intervelometer;	///< Pointer to a intervelometer class.
+		pan_stepper* p_pan;					///< Pointer to the pan axis stepper.
+		estop* p_estop;						///< Pointer to the emergency stop input.
 		
+		// Works out how long to let the rig settle after a move
+		unsigned int settle_time_ms (unsigned int, unsigned int);
+		
+		// Works out how long a slide move takes
+		unsigned long move_time_ms (unsigned int, unsigned int);
+		
+		// Works out where the pan axis must point to keep the subject centred
+		long pan_track_target (unsigned long);
+		
+		// Starts the pan and tilt moves to a frame of the pano grid
+		unsigned long pano_move_to_frame (unsigned int);
+		
+		// Counts how many frames fit in the time left
+		unsigned int plan_frames (unsigned int, unsigned long);
+		
+		// Moves the end of the frame plan a little toward what fits in the time left
+		unsigned int replan_frames (unsigned long);
+		
+		// Counts how many frames fit on a fixed frame period grid
+		unsigned int plan_grid_frames (unsigned long);
+		
+		// Exposure for one shot of an HDR bracket
+		unsigned long bracket_exposure (unsigned long, unsigned char);
+		
+		// Time one frame takes, all bracket shots and delays but not the move
+		unsigned long frame_time_ms (unsigned int);
+		
+		// The part of a frame's time which follows the exposure ramp
+		unsigned long shots_time_ms (unsigned int);
+		
+		// The part of a frame's time which is the same for every frame
+		unsigned long after_time_ms (void);
+		
+		// Hands the camera settings in the menu to the intervelometer as a run starts
+		void camera_setup (void);
+		
+		// Writes the time stamp of the last sync input edge to the serial port
+		void log_sync (void);
+		
+		// Checks whether the next frame is due on the fixed frame period grid
+		bool frame_due (void);
+		
+		// Writes the estimated current of the last frame of a low power run
+		void report_power (void);
+		
+		ramp exposureRamp;					///< Exposure time for each frame, in ms
+		ramp intervalRamp;					///< Frame period for each frame, in ms
 		
 	
 	public:
 		// The constructor creates a new task object
-		task_navigation (time_stamp*,  base_text_serial*, task_timer*, avr_adc*, stepper*, intervelometer*);
+		task_navigation (time_stamp*,  base_text_serial*, task_timer*, avr_adc*, stepper*, intervelometer*, pan_stepper*, estop*);
           char run (char);
 		
 		unsigned long num;
@@ -57,6 +107,32 @@ class task_navigation : public stl_task
 		unsigned int lastPicNumber;
 		unsigned int motorSteps;
 		unsigned int timerCount;
+		unsigned int settleTime;			///< Dwell after the last move, in ms
+		unsigned int panTimerCount;			///< Timer 1 count for pan moves
+		long panStartTarget;				///< Tracking pan angle at the first frame, in steps
+		bool estopReported;					///< E-stop message has been sent
+		unsigned int panoFrame;				///< Pano frame being taken, serpentine order
+		unsigned int panoFrames;			///< Frames in the pano grid
+		unsigned long panoColSteps;			///< Pan steps between pano columns
+		unsigned long panoRowSteps;			///< Tilt steps between pano rows
+		long panoPanOrigin;					///< Pan position of the first pano column
+		long panoTiltOrigin;				///< Tilt position of the first pano row
+		long tiltZero;						///< Step count on the slide output where the pano started, tilt 0
+		bool panoActive;					///< A pano is under way and the head isn't back where it started
+		unsigned long frameBudget;			///< Time for frames in the run (not moves), in ms
+		unsigned long frameTimeUsed;		///< Frame time used so far, in ms
+		unsigned int planEnd;				///< Frame the plan ends before
+		unsigned long planShotsMs;			///< Shots time of frames left in the plan, in ms
+		unsigned long stepsDone;			///< Slide steps moved so far in the run
+		unsigned char bracketShot;			///< Next shot of the HDR bracket at this frame
+		unsigned long framePeriod;			///< Fixed frame period in ms, 0 when frames follow their phases
+		unsigned long nextFrameTime;		///< Time the next frame is due on the grid, in ms
+		bool frameWaiting;					///< Slack for the next frame has been recorded
+		unsigned int overrunCount;			///< Frames that started after their grid time
+		unsigned long overrunMax;			///< Worst overrun in the run, in ms
+		unsigned long minSlack;				///< Least time to spare before a frame, in ms
+		unsigned long lastFrameTime;		///< Time the last low power frame started, in ms
+		time_stamp runInterval;				///< Task interval to go back to after a low power run
 
 };
 #endif
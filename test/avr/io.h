@@ -0,0 +1,29 @@
+//*************************************************************************************
+/** \file test/avr/io.h
+ *	Stand-in for avr-libc's io.h so code that only writes a few timer registers can be
+ *	run on the host. The registers are plain variables, defined by the test that uses
+ *	them, and the bit numbers are the ATmega2560's.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _TEST_IO_H_
+#define _TEST_IO_H_                     	///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+
+extern uint8_t TCCR2A;					// Timer 2 control A, COM2A0 switches the carrier
+extern uint8_t OCR2A;					// Timer 2 top, sets the carrier
+extern uint16_t TCNT3;					// Timer 3 count, 0.5us ticks
+extern uint16_t OCR3C;					// Timer 3 compare C
+extern uint8_t TIMSK3;					// Timer 3 interrupt mask
+extern uint8_t TIFR3;					// Timer 3 interrupt flags
+
+#define COM2A0		6
+#define OCIE3C		3
+#define OCF3C		3
+
+#endif
@@ -0,0 +1,23 @@
+//*************************************************************************************
+/** \file test/avr/pgmspace.h
+ *	Stand-in for avr-libc's pgmspace.h so the integer math files can be built and
+ *	checked on the host. The host has no separate flash space, so tables stay in RAM
+ *	and are read directly.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#ifndef _TEST_PGMSPACE_H_
+#define _TEST_PGMSPACE_H_                     	///< Prevents multiple inclusion of file
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t*)(addr))
+
+#endif
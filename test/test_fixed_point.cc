@@ -0,0 +1,155 @@
+//*************************************************************************************
+/** \file test/test_fixed_point.cc
+ *	Host check of the exposure ramp math against libm. fx_log2_q16() is run over the
+ *	whole 32 bit range and has to be within FX_LOG2_TOLERANCE of log2(); fx_scale_pow2()
+ *	is run over ramp values from 1ms to 100 minutes scaled by up to 20 stops either
+ *	way and has to be within FX_SCALE_TOLERANCE_PPM of the exact product (or a count,
+ *	for small results), and has to saturate when the product doesn't fit. The
+ *	exponential ramps built on them are then held against the exact curve at every
+ *	frame. Built and run by 'make host_test'.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <math.h>
+#include "../fixed_point.h"
+#include "../ramp.h"
+
+/// Most fx_log2_q16() may be off, in Q16.16 units (0.00003)
+#define FX_LOG2_TOLERANCE		2
+
+/// Most fx_scale_pow2() may be off, in parts per million (0.1%)
+#define FX_SCALE_TOLERANCE_PPM	1000
+
+/// Longest ramp value checked, in ms (100 minutes)
+#define FX_RAMP_MAX				6000000UL
+
+static unsigned int failures = 0;
+
+//Checks fx_log2_q16() at one value
+static double check_log2 (uint32_t x)
+{
+	double exact = log2 ((double)x) * 65536.0;
+	double error = fabs ((double)fx_log2_q16 (x) - exact);
+
+	if (error > FX_LOG2_TOLERANCE)
+	{
+		printf ("FAIL fx_log2_q16(%lu): got %ld, libm %.1f\n", (unsigned long)x, (long)fx_log2_q16 (x), exact);
+		failures++;
+	}
+	return error;
+}
+
+//Checks fx_scale_pow2() at one value and power of two, returns the error in ppm
+static double check_scale (uint32_t x, int32_t e)
+{
+	double exact = (double)x * exp2 ((double)e / 65536.0);
+	uint32_t got = fx_scale_pow2 (x, e);
+	double error;
+
+	if (exact >= 4294967295.0)
+	{
+		if (got != 0xFFFFFFFFUL)
+		{
+			printf ("FAIL fx_scale_pow2(%lu, %ld): got %lu, should saturate\n", (unsigned long)x, (long)e, (unsigned long)got);
+			failures++;
+		}
+		return 0;
+	}
+
+	error = fabs ((double)got - exact);
+	if ((error > 1.0) && (error > exact * FX_SCALE_TOLERANCE_PPM / 1e6))
+	{
+		printf ("FAIL fx_scale_pow2(%lu, %ld): got %lu, libm %.1f\n", (unsigned long)x, (long)e, (unsigned long)got, exact);
+		failures++;
+	}
+	return (exact > 1000.0) ? error * 1e6 / exact : 0;
+}
+
+//Checks an exponential ramp at every frame against start * (end / start)^t, with t
+// the frame's place along the ramp in the Q12 the ramp uses
+static double check_ramp (unsigned long start, unsigned long end, unsigned int frames)
+{
+	ramp r;
+	double worst = 0;
+
+	r.set (start, end, RAMP_EXP, 0, frames);
+	for (unsigned int frame = 1; frame < frames; frame++)
+	{
+		double t = (double)(((unsigned long)frame << 12) / frames) / 4096.0;
+		double exact = start * pow ((double)end / start, t);
+		double error = fabs ((double)r.value (frame) - exact);
+
+		if ((error > 1.0) && (error > exact * FX_SCALE_TOLERANCE_PPM / 1e6))
+		{
+			printf ("FAIL ramp %lu to %lu, frame %u of %u: got %lu, libm %.1f\n", start, end, frame, frames,
+				r.value (frame), exact);
+			failures++;
+		}
+		if ((exact > 1000.0) && (error * 1e6 / exact > worst))
+		{
+			worst = error * 1e6 / exact;
+		}
+	}
+	return worst;
+}
+
+int main (void)
+{
+	double worst_log2 = 0;
+	double worst_scale = 0;
+	double worst_ramp = 0;
+	double error;
+
+	//every power of two and its neighbours, then a fine geometric sweep
+	for (uint8_t bit = 0; bit < 32; bit++)
+	{
+		for (int32_t d = -2; d <= 2; d++)
+		{
+			uint32_t x = (1UL << bit) + d;
+			if ((x > 0) && ((error = check_log2 (x)) > worst_log2))
+			{
+				worst_log2 = error;
+			}
+		}
+	}
+	for (double x = 1.0; x < 4294967295.0; x *= 1.0007)
+	{
+		if ((error = check_log2 ((uint32_t)x)) > worst_log2)
+		{
+			worst_log2 = error;
+		}
+	}
+
+	for (double x = 1.0; x <= FX_RAMP_MAX; x *= 1.37)
+	{
+		for (int32_t e = -20L * 65536; e <= 20L * 65536; e += 1237)
+		{
+			if ((error = check_scale ((uint32_t)x, e)) > worst_scale)
+			{
+				worst_scale = error;
+			}
+		}
+	}
+
+	static const unsigned long ends[] = { 1, 30, 1000, 20000, 300000, FX_RAMP_MAX };
+	for (unsigned char i = 0; i < sizeof (ends) / sizeof (ends[0]); i++)
+	{
+		for (unsigned char j = 0; j < sizeof (ends) / sizeof (ends[0]); j++)
+		{
+			if ((error = check_ramp (ends[i], ends[j], 997)) > worst_ramp)
+			{
+				worst_ramp = error;
+			}
+		}
+	}
+
+	printf ("fx_log2_q16: worst error %.2f/65536\n", worst_log2);
+	printf ("fx_scale_pow2: worst error %.0f ppm, ramps %.0f ppm\n", worst_scale, worst_ramp);
+	printf ("fixed point: %u failures\n", failures);
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+//*************************************************************************************
+/** \file test/test_ir.cc
+ *	Host check of the IR remote bursts. Each table in ir_codes.h is sent through
+ *	ir_burst_start() and ir_burst_edge() against stand-in timer registers, firing the
+ *	compare interrupt at each OCR3C value the way Timer 3 would, 16 bit wrap and all.
+ *	Every carrier on and off is then held against the remote's protocol, counted from
+ *	the first mark so an error can't hide by adding up, and has to land within one
+ *	0.5us tick. The carrier has to be within 1% of the protocol's. Built and run by
+ *	'make host_test'.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../ir_burst.h"
+#include "../ir_codes.h"
+
+/// Most an edge may be off from the protocol, in Timer 3 ticks
+#define IR_TOLERANCE	1
+
+/// Most edges a burst may have, repeats included
+#define IR_MAX_EDGES	512
+
+/// Sony shutter command, sent LSB first
+#define SONY_SHUTTER	0xB4B8FUL
+
+uint8_t TCCR2A;
+uint8_t OCR2A;
+uint16_t TCNT3;
+uint16_t OCR3C;
+uint8_t TIMSK3;
+uint8_t TIFR3;
+
+const uint16_t* volatile ir_code = 0;
+volatile uint8_t ir_index;
+volatile uint8_t ir_repeats;
+volatile unsigned long ir_left;
+
+//One remote as its protocol gives it: marks and spaces in us turn about, 0 ended
+typedef struct
+{
+	const char* name;
+	const uint16_t* table;
+	unsigned long carrier_hz;
+	unsigned char repeats;
+	uint16_t burst[48];
+} ir_protocol;
+
+static ir_protocol protocol[] =
+{
+	//ML-L3: three short marks after the start mark, the burst is sent twice 63.2ms apart
+	{ "nikon", ir_nikon, 38400, 2, { 2000, 27830, 390, 1580, 410, 3580, 400, 63200, 0 } },
+	//RC-1: 16 carrier cycles, 7.33ms, 16 cycles again for shoot now
+	{ "canon", ir_canon, 32700, 1, { 490, 7330, 490, 0 } },
+	//SIRC 20 bit, filled in by sony_burst()
+	{ "sony", ir_sony, 40000, 3, { 0 } },
+};
+
+//Builds the Sony burst from the command: a 2400us start mark, then a 1200us mark for
+// a one or 600us for a zero, each with a 600us space, and the last space padding the
+// frame out to 45ms
+static void sony_burst(uint16_t* burst)
+{
+	unsigned long frame_us = 2400 + 600;
+	unsigned char n = 0;
+
+	burst[n++] = 2400;
+	burst[n++] = 600;
+	for (unsigned char bit = 0; bit < 20; bit++)
+	{
+		burst[n] = ((SONY_SHUTTER >> bit) & 1) ? 1200 : 600;
+		frame_us += burst[n++] + 600;
+		burst[n++] = 600;
+	}
+	burst[n - 1] += 45000 - frame_us;
+	burst[n] = 0;
+}
+
+//Sends one table and records when the carrier goes on or off, in ticks from the
+// start. The end of the burst counts as an off edge. Returns the number of edges
+static unsigned int send_burst(const uint16_t* table, unsigned long* edge_at, bool* edge_on)
+{
+	unsigned long now = 0;
+	unsigned int edges = 0;
+	bool on = false;
+
+	TCNT3 = 0xFFF0;					//starting near the wrap, the first pieces cross it
+	TCCR2A = 0;
+	TIMSK3 = 0;
+	ir_code = table;
+	ir_burst_start();
+	now = (uint16_t)(OCR3C - TCNT3);
+
+	while ((TIMSK3 & (1<<OCIE3C)) && (edges < IR_MAX_EDGES))
+	{
+		uint16_t compare = OCR3C;
+		uint16_t ticks;
+
+		ir_burst_edge();
+
+		if (((TCCR2A & (1<<COM2A0)) != 0) != on)
+		{
+			on = !on;
+			edge_at[edges] = now;
+			edge_on[edges++] = on;
+		}
+		else if (!(TIMSK3 & (1<<OCIE3C)))
+		{
+			edge_at[edges] = now;
+			edge_on[edges++] = false;
+		}
+
+		//the next match is a whole turn of the timer away if the compare didn't move
+		ticks = OCR3C - compare;
+		now += (ticks == 0) ? 0x10000UL : ticks;
+	}
+	return edges;
+}
+
+int main (void)
+{
+	unsigned int failures = 0;
+
+	sony_burst(protocol[2].burst);
+
+	for (unsigned char p = 0; p < sizeof (protocol) / sizeof (protocol[0]); p++)
+	{
+		const ir_protocol* proto = &protocol[p];
+		unsigned long edge_at[IR_MAX_EDGES];
+		bool edge_on[IR_MAX_EDGES];
+		unsigned int edges = send_burst(proto->table, edge_at, edge_on);
+		unsigned long carrier = 16000000UL / (2 * ((unsigned long)OCR2A + 1));
+		unsigned long expect = 0;
+		unsigned int n = 0;
+		int worst = 0;
+
+		if (labs ((long)carrier - (long)proto->carrier_hz) * 100 > (long)proto->carrier_hz)
+		{
+			printf ("FAIL %s: carrier %lu Hz, protocol %lu Hz\n", proto->name, carrier, proto->carrier_hz);
+			failures++;
+		}
+
+		for (unsigned char r = 0; r < proto->repeats; r++)
+		{
+			for (unsigned char i = 0; proto->burst[i] != 0; i++, n++)
+			{
+				int error;
+
+				if (n >= edges)
+				{
+					printf ("FAIL %s: burst ended after %u edges\n", proto->name, edges);
+					failures++;
+					break;
+				}
+				error = abs ((int)((long)(edge_at[n] - edge_at[0]) - (long)expect));
+				if (error > worst)
+				{
+					worst = error;
+				}
+				if ((error > IR_TOLERANCE) || (edge_on[n] != ((i & 1) == 0)))
+				{
+					printf ("FAIL %s: edge %u at %lu ticks %s, protocol %lu ticks %s\n", proto->name, n,
+						edge_at[n] - edge_at[0], edge_on[n] ? "on" : "off", expect, ((i & 1) == 0) ? "on" : "off");
+					failures++;
+				}
+				expect += 2UL * proto->burst[i];
+			}
+		}
+
+		//the last space ends the burst
+		if ((n >= edges) || edge_on[n] || (labs ((long)(edge_at[n] - edge_at[0]) - (long)expect) > IR_TOLERANCE))
+		{
+			printf ("FAIL %s: burst doesn't end at %lu ticks\n", proto->name, expect);
+			failures++;
+		}
+		else if (n + 1 != edges)
+		{
+			printf ("FAIL %s: %u edges, protocol %u\n", proto->name, edges, n + 1);
+			failures++;
+		}
+
+		printf ("%s: %u edges, carrier %lu Hz, worst error %d ticks\n", proto->name, edges, carrier, worst);
+	}
+
+	printf ("ir bursts: %u failures\n", failures);
+	return (failures == 0) ? 0 : 1;
+}
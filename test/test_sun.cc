@@ -0,0 +1,180 @@
+//*************************************************************************************
+/** \file test/test_sun.cc
+ *	Host check of sun_calc() against a reference table. The reference times come from
+ *	the NOAA Solar Calculator method (Meeus' solar coordinates, the equation of time
+ *	and the same zenith angles as sun.cc), worked out in double precision and iterated
+ *	at the time of each event. Every time has to be within SUN_TOLERANCE minutes of
+ *	the table, and an event the table says doesn't happen must come out SUN_NONE.
+ *	Built and run by 'make host_test'.
+ *
+ *  License:
+ *	This file released under the Lesser GNU Public License, version 2. This program
+ *	is intended for educational use only, but its use is not limited thereto.
+ */
+//*************************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../sun.h"
+
+/// Most a time may be off from the reference, in minutes
+#define SUN_TOLERANCE	2
+
+//One row of the reference table: place, date and the four times in local minutes
+typedef struct
+{
+	int16_t lat;				// hundredths of a degree, north positive
+	int16_t lon;				// hundredths of a degree, east positive
+	int16_t utc_offset;			// minutes
+	uint16_t year;
+	uint8_t month;
+	uint8_t day;
+	int16_t times[4];			// dawn, sunrise, sunset, dusk
+} sun_reference;
+
+static const sun_reference reference[] =
+{
+	{  5150,    -13,    0, 2024,  1, 15,  441,  480,  980, 1019 },
+	{  5150,    -13,    0, 2024,  3, 20,  329,  362, 1094, 1128 },
+	{  5150,    -13,    0, 2024,  6, 21,  175,  223, 1222, 1269 },
+	{  5150,    -13,    0, 2024,  9, 22,  314,  347, 1078, 1111 },
+	{  5150,    -13,    0, 2024, 12, 21,  444,  484,  954,  994 },
+	{  5150,    -13,    0, 2025,  2,  3,  419,  455, 1014, 1050 },
+	{  5150,    -13,    0, 2025,  8,  9,  238,  277, 1174, 1213 },
+	{  5150,    -13,    0, 2026, 10, 18,  356,  389, 1021, 1055 },
+	{  4071,  -7401, -300, 2024,  1, 15,  408,  438, 1013, 1043 },
+	{  4071,  -7401, -300, 2024,  3, 20,  331,  358, 1089, 1116 },
+	{  4071,  -7401, -300, 2024,  6, 21,  232,  265, 1171, 1204 },
+	{  4071,  -7401, -300, 2024,  9, 22,  317,  344, 1072, 1100 },
+	{  4071,  -7401, -300, 2024, 12, 21,  406,  437,  992, 1023 },
+	{  4071,  -7401, -300, 2025,  2,  3,  395,  424, 1037, 1065 },
+	{  4071,  -7401, -300, 2025,  8,  9,  271,  301, 1142, 1171 },
+	{  4071,  -7401, -300, 2026, 10, 18,  343,  371, 1031, 1059 },
+	{  3386,  15121,  600, 2024,  1, 15,  393,  420, 1028, 1056 },
+	{  3386,  15121,  600, 2024,  3, 20,  334,  359, 1087, 1112 },
+	{  3386,  15121,  600, 2024,  6, 21,  256,  285, 1149, 1178 },
+	{  3386,  15121,  600, 2024,  9, 22,  318,  343, 1072, 1097 },
+	{  3386,  15121,  600, 2024, 12, 21,  389,  416, 1010, 1038 },
+	{  3386,  15121,  600, 2025,  2,  3,  385,  411, 1048, 1074 },
+	{  3386,  15121,  600, 2025,  8,  9,  286,  312, 1128, 1155 },
+	{  3386,  15121,  600, 2026, 10, 18,  337,  362, 1038, 1063 },
+	{ -3392,   1842,  120, 2024,  1, 15,  322,  350, 1200, 1229 },
+	{ -3392,   1842,  120, 2024,  3, 20,  385,  410, 1137, 1162 },
+	{ -3392,   1842,  120, 2024,  6, 21,  444,  471, 1065, 1093 },
+	{ -3392,   1842,  120, 2024,  9, 22,  370,  395, 1123, 1148 },
+	{ -3392,   1842,  120, 2024, 12, 21,  303,  332, 1197, 1226 },
+	{ -3392,   1842,  120, 2025,  2,  3,  343,  370, 1190, 1217 },
+	{ -3392,   1842,  120, 2025,  8,  9,  425,  451, 1093, 1119 },
+	{ -3392,   1842,  120, 2026, 10, 18,  336,  361, 1142, 1168 },
+	{  3569,  13969,  540, 2024,  1, 15,  383,  411, 1010, 1038 },
+	{  3569,  13969,  540, 2024,  3, 20,  319,  345, 1073, 1098 },
+	{  3569,  13969,  540, 2024,  6, 21,  236,  266, 1140, 1171 },
+	{  3569,  13969,  540, 2024,  9, 22,  304,  329, 1058, 1084 },
+	{  3569,  13969,  540, 2024, 12, 21,  379,  407,  992, 1020 },
+	{  3569,  13969,  540, 2025,  2,  3,  373,  400, 1031, 1057 },
+	{  3569,  13969,  540, 2025,  8,  9,  268,  295, 1118, 1145 },
+	{  3569,  13969,  540, 2026, 10, 18,  324,  350, 1022, 1048 },
+	{ -2291,  -4317, -180, 2024,  1, 15,  295,  320, 1124, 1148 },
+	{ -2291,  -4317, -180, 2024,  3, 20,  334,  357, 1083, 1105 },
+	{ -2291,  -4317, -180, 2024,  6, 21,  368,  393, 1036, 1061 },
+	{ -2291,  -4317, -180, 2024,  9, 22,  319,  342, 1069, 1091 },
+	{ -2291,  -4317, -180, 2024, 12, 21,  279,  305, 1117, 1143 },
+	{ -2291,  -4317, -180, 2025,  2,  3,  310,  334, 1119, 1142 },
+	{ -2291,  -4317, -180, 2025,  8,  9,  358,  382, 1055, 1078 },
+	{ -2291,  -4317, -180, 2026, 10, 18,  295,  318, 1078, 1101 },
+	{  6021,   2494,  120, 2024,  1, 15,  497,  550,  949, 1003 },
+	{  6021,   2494,  120, 2024,  3, 20,  339,  381, 1116, 1158 },
+	{  6021,   2494,  120, 2024,  6, 21,   60,  174, 1311, 1425 },
+	{  6021,   2494,  120, 2024,  9, 22,  323,  365, 1099, 1141 },
+	{  6021,   2494,  120, 2024, 12, 21,  506,  564,  913,  971 },
+	{  6021,   2494,  120, 2025,  2,  3,  463,  510,  999, 1046 },
+	{  6021,   2494,  120, 2025,  8,  9,  204,  259, 1231, 1285 },
+	{  6021,   2494,  120, 2026, 10, 18,  384,  427, 1022, 1065 },
+	{ -5480,  -6830, -180, 2024,  1, 15,  270,  322, 1322, 1374 },
+	{ -5480,  -6830, -180, 2024,  3, 20,  419,  455, 1184, 1220 },
+	{ -5480,  -6830, -180, 2024,  6, 21,  554,  599, 1031, 1077 },
+	{ -5480,  -6830, -180, 2024,  9, 22,  404,  440, 1172, 1208 },
+	{ -5480,  -6830, -180, 2024, 12, 21,  234,  292, 1332, 1389 },
+	{ -5480,  -6830, -180, 2025,  2,  3,  318,  362, 1291, 1335 },
+	{ -5480,  -6830, -180, 2025,  8,  9,  507,  546, 1092, 1131 },
+	{ -5480,  -6830, -180, 2026, 10, 18,  338,  376, 1222, 1261 },
+	{     0,      0,    0, 2024,  1, 15,  343,  366, 1093, 1115 },
+	{     0,      0,    0, 2024,  3, 20,  343,  364, 1091, 1111 },
+	{     0,      0,    0, 2024,  6, 21,  336,  358, 1086, 1108 },
+	{     0,      0,    0, 2024,  9, 22,  329,  349, 1076, 1096 },
+	{     0,      0,    0, 2024, 12, 21,  332,  355, 1082, 1105 },
+	{     0,      0,    0, 2025,  2,  3,  349,  370, 1097, 1119 },
+	{     0,      0,    0, 2025,  8,  9,  341,  362, 1089, 1110 },
+	{     0,      0,    0, 2026, 10, 18,  321,  342, 1068, 1089 },
+	{  1929,  -9913, -360, 2024,  1, 15,  410,  433, 1099, 1122 },
+	{  1929,  -9913, -360, 2024,  3, 20,  378,  400, 1128, 1150 },
+	{  1929,  -9913, -360, 2024,  6, 21,  335,  360, 1157, 1182 },
+	{  1929,  -9913, -360, 2024,  9, 22,  364,  386, 1112, 1134 },
+	{  1929,  -9913, -360, 2024, 12, 21,  402,  426, 1084, 1108 },
+	{  1929,  -9913, -360, 2025,  2,  3,  407,  430, 1111, 1134 },
+	{  1929,  -9913, -360, 2025,  8,  9,  353,  376, 1148, 1171 },
+	{  1929,  -9913, -360, 2026, 10, 18,  370,  392, 1091, 1113 },
+	{  4740, -12230, -480, 2024,  1, 15,  438,  472, 1005, 1040 },
+	{  4740, -12230, -480, 2024,  3, 20,  340,  371, 1103, 1134 },
+	{  4740, -12230, -480, 2024,  6, 21,  212,  252, 1210, 1250 },
+	{  4740, -12230, -480, 2024,  9, 22,  326,  357, 1086, 1116 },
+	{  4740, -12230, -480, 2024, 12, 21,  438,  474,  981, 1017 },
+	{  4740, -12230, -480, 2025,  2,  3,  419,  452, 1035, 1067 },
+	{  4740, -12230, -480, 2025,  8,  9,  264,  298, 1170, 1205 },
+	{  4740, -12230, -480, 2026, 10, 18,  361,  392, 1035, 1067 },
+	{  5575,   3762,  180, 2024,  1, 15,  486,  530,  988, 1032 },
+	{  5575,   3762,  180, 2024,  3, 20,  354,  391, 1124, 1161 },
+	{  5575,   3762,  180, 2024,  6, 21,  163,  225, 1278, 1340 },
+	{  5575,   3762,  180, 2024,  9, 22,  338,  375, 1108, 1145 },
+	{  5575,   3762,  180, 2024, 12, 21,  491,  538,  958, 1005 },
+	{  5575,   3762,  180, 2025,  2,  3,  459,  499, 1028, 1069 },
+	{  5575,   3762,  180, 2025,  8,  9,  245,  290, 1219, 1263 },
+	{  5575,   3762,  180, 2026, 10, 18,  388,  426, 1042, 1080 },
+};
+
+static const char* const event_name[4] = { "dawn", "sunrise", "sunset", "dusk" };
+
+int main (void)
+{
+	unsigned int count = sizeof (reference) / sizeof (reference[0]);
+	unsigned int failures = 0;
+	int worst = 0;
+
+	for (unsigned int row = 0; row < count; row++)
+	{
+		const sun_reference* ref = &reference[row];
+		sun_times times;
+
+		sun_calc (ref->lat, ref->lon, ref->utc_offset, ref->year, ref->month, ref->day, &times);
+		int16_t got[4] = { times.dawn, times.sunrise, times.sunset, times.dusk };
+
+		for (unsigned char event = 0; event < 4; event++)
+		{
+			int error;
+
+			if ((ref->times[event] == SUN_NONE) || (got[event] == SUN_NONE))
+			{
+				error = (ref->times[event] == got[event]) ? 0 : 1440;
+			}
+			else
+			{
+				//times are minutes of the day, so the error wraps round midnight
+				error = abs (((got[event] - ref->times[event]) % 1440 + 2160) % 1440 - 720);
+			}
+
+			if (error > worst)
+			{
+				worst = error;
+			}
+			if (error > SUN_TOLERANCE)
+			{
+				printf ("FAIL %d,%d %u-%02u-%02u %s: got %d, reference %d\n", ref->lat, ref->lon,
+					ref->year, ref->month, ref->day, event_name[event], got[event], ref->times[event]);
+				failures++;
+			}
+		}
+	}
+
+	printf ("sun_calc: %u days, worst error %d min, %u failures\n", count, worst, failures);
+	return (failures == 0) ? 0 : 1;
+}
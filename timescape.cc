@@ -31,10 +31,14 @@
 #include "rs232.h"				// Include header for serial port class
 #include "stl_timer.h"          // Microsecond-resolution timer
 #include "stl_task.h"          	// Base class for all task classes
+#include "stl_scheduler.h"     	// Runs the tasks in order of priority
 //#include "avr_adc.h"			// Include header for the A/D class
 #include "lcd.h"				// Include for sparkfun lcd control with HD44780 controller
 #include "stepper.h"			// Include for stepper motor driver 
 #include "intervelometer.h"		// Intervelometer code
+#include "pan_stepper.h"		// Include for the pan axis stepper driver
+#include "estop.h"				// Include for the emergency stop input
+#include "ramp.h"				// Include for exposure ramps
 
 #include "avr_adc.h"
 
@@ -43,15 +47,39 @@
 #include "menu.h"
 #include "task_menu.h"
 #include "task_navigation.h"
+#include "task_log.h"
 
 
+//Time one wake from idle sleep takes when no task is due, in us: the wake up, the ISR
+//  (the 1kHz Timer 5 tick, mostly) and idle()'s deadline check come to about 320
+//  cycles by count. Low power runs add it for every sleep idle() reports
+#define WAKE_US		20
+
 //Initialize Global Variables
 volatile unsigned long timer_overflow; 		//Global variable for keeping track of each timer4 in stepper.h
 volatile unsigned long steps;				//Variable that tells you how many steps to move
+volatile long slide_position = 0;			//Slide position in steps
+volatile signed char slide_direction = 1;	//+1 or -1 depending on slide direction pin
 
-volatile unsigned int shutter_compare = 0; 	// variable for keeping track of shutter timer. 
-volatile unsigned int shutter_speed = 0;	// variable that tells you what shutter speed is
+volatile seq_entry seq_table[SEQ_TABLE_SIZE];	// sequence the Timer 5 ISR is walking
+volatile uint8_t seq_index = 0;				// entry being run
+volatile unsigned long seq_left = 0;		// ms left in that entry, 0 when idle
+volatile unsigned long seq_entry_start = 0;	// seq_time_ms when that entry started
+volatile unsigned int seq_focus_hold = 0;	// focus release to start at the end entry
+volatile uint16_t seq_frame = 0;			// frame number for the frame log
+volatile unsigned long seq_time_ms = 0;		// ms since power up, Timer 5 never stops
 volatile bool inTakePicMode = false;
+volatile unsigned int focus_release_left = 0;	// ms until the focus line is let go
+volatile unsigned int settle_left = 0;		// ms left in the motor delay, runs beside the table
+volatile bool sync_captured = false;		// an edge came in on the sync input
+volatile unsigned char sync_phase = 0;		// SYNC_PHASE_ the edge came in during
+volatile unsigned long sync_ms = 0;			// ms into that phase the edge came at
+volatile uint16_t sync_ticks = 0;			// and 4us ticks past that ms
+
+volatile frame_record frame_ring[FRAME_LOG_SIZE];	// frame log records waiting to be sent
+volatile uint8_t frame_ring_head = 0;		// next record the ISR writes
+volatile uint8_t frame_ring_tail = 0;		// next record task_log sends
+volatile uint16_t frame_ring_dropped = 0;	// records lost because the ring was full
 
 volatile int16_t button_presscount = 0;		//Varible to for menu system that keeps track number of button presses.
 
@@ -59,17 +87,85 @@ volatile int16_t button_presscount = 0;		//Varible to for menu system that keeps
 volatile unsigned char init_left = 0;
 volatile unsigned char init_right = 0;
 volatile unsigned char startTimelapse = 0;
+volatile unsigned char startPano = 0;
+volatile unsigned char lowPowerRun = 0;		//set by task_navigation during a low power run
+unsigned long awake_us = 0;				//microseconds spent awake, low power runs
 volatile bool inPicDelayMode = false;
 volatile bool inMotorDelayMode = false;
 volatile bool inMoveMotorMode = false;
 volatile bool motorMoveComplete = false;
 
+volatile unsigned long pan_timer_overflow;	//Steps taken in the current pan move
+volatile unsigned long pan_steps;			//Steps to take in the current pan move
+volatile signed char pan_direction = 1;		//+1 or -1 depending on pan direction pin
+volatile long pan_position = 0;				//Pan axis position in steps
+volatile bool inPanMoveMode = false;		//true while the pan axis is moving
+volatile bool pan_tracking = false;			//true while the pan axis is tracking the sky
+volatile uint16_t pan_track_top;			//whole Timer 1 ticks per tracking period, less one
+volatile uint32_t pan_track_frac;			//fraction of a tick per tracking period, Q32
+volatile uint32_t pan_track_acc;			//fractions of a tick built up so far, Q32
+volatile uint16_t pan_track_div;			//tracking periods per step
+volatile uint16_t pan_track_sub;			//tracking periods left before the one that steps
+
+const uint16_t* volatile ir_code = 0;		//IR burst table in flash, 0 for no IR remote
+volatile uint8_t ir_index;					//IR table entry being sent
+volatile uint8_t ir_repeats;				//IR bursts left to send
+volatile unsigned long ir_left;				//Timer 3 ticks left in the IR entry
+
+volatile bool estop_latched = false;		//true from an e-stop until it is acknowledged
+volatile uint16_t estop_isr_ticks = 0;		//Timer 3 ticks the e-stop ISR took to stop outputs
+volatile unsigned char estop_clear = 0;		//set from the menu to acknowledge an e-stop
+
 
 //--------------------------------------------------------------------------------------
 //-------------------Timer Interrupt Subroutine (BEGIN)---------------------------------
  #define PWM_FREQ     	OCR4A
 
 
+//Emergency stop. Step outputs are disconnected from the timers first since that is
+// what actually stops the motors, then the step generators, pan axis and shutter are
+// shut down and the fault is latched for task_navigation.
+ISR(INT4_vect)
+{
+	uint16_t entry = TCNT3;
+	
+	//step pins back to plain port pins, driven low
+	TCCR4A &= ~((1<<COM4A1) | (1<<COM4B1));
+	TCCR1A &= ~(1<<COM1B1);
+	PORTH &= ~((1<<PORTH3) | (1<<PORTH4));
+	PORTB &= ~(1<<PORTB6);
+	
+	estop_isr_ticks = TCNT3 - entry;
+	
+	//slide step generator
+	PWM_FREQ = 0;
+	steps = 0;
+	inMoveMotorMode = false;
+	
+	//pan step generator
+	TCCR1B &= ~((1<<CS10) | (1<<CS11) | (1<<CS12));
+	OCR1A = 0;
+	pan_steps = 0;
+	inPanMoveMode = false;
+	pan_tracking = false;
+	
+	//IR remote
+	TIMSK3 &= ~(1<<OCIE3C);
+	TCCR2A &= ~(1<<COM2A0);
+	
+	//shutter sequence, release both shutters and focus. The clock keeps running since
+	// it is the time base, with no table entry left it does nothing else
+	PORTL &= ~((1<<PORTL5) | (1<<PORTL4) | (1<<PORTL3));
+	focus_release_left = 0;
+	seq_left = 0;
+	settle_left = 0;
+	inTakePicMode = false;
+	inPicDelayMode = false;
+	inMotorDelayMode = false;
+	
+	estop_latched = true;
+}
+
 //Interrupt subroutine for checking how many steps has been taken and 
 // stop the motor once number of steps has been completed
 ISR(TIMER4_OVF_vect)
@@ -77,6 +173,12 @@ ISR(TIMER4_OVF_vect)
 	//update_timer();
 	timer_overflow = timer_overflow + 1;
 	
+	//the timer keeps overflowing with a TOP of 0 while the slide is idle
+	if (PWM_FREQ != 0)
+	{
+		slide_position = slide_position + slide_direction;
+	}
+	
 	// if (steps > 0)
 	// {
 		// inMoveMotorMode = true;
@@ -91,59 +193,187 @@ ISR(TIMER4_OVF_vect)
 	}
 }
 
-//Interupt routine for intervelometer.
-ISR(TIMER5_COMPC_vect)
+//Interrupt subroutine for counting pan axis steps, the same as Timer 4 does for
+// the slide. The clock is stopped once the move is done. While tracking the sky it
+// never stops: each period it adds the fraction of a tick to the accumulator and
+// stretches the next period by a tick when that carries, so the rounding never
+// builds up. TOP is buffered until BOTTOM, one tick after this interrupt.
+ISR(TIMER1_OVF_vect)
 {
-	shutter_compare = shutter_compare + 1;	//add 1 seconds to it.
-	
-	//Taking picture mode
-	if ((shutter_compare == shutter_speed) && (inTakePicMode == true))
+	if (pan_tracking)
 	{
-		//toggle pin LOW
-		PORTL &= ~(1<<PORTL5);
+		uint32_t acc = pan_track_acc + pan_track_frac;
 		
-		//PORTL ^= (1<<PORTL5);
+		OCR1A = pan_track_top + ((acc < pan_track_acc) ? 1 : 0);
+		pan_track_acc = acc;
 		
-		//turn off timer by setting pre-scalar 0
-		TCCR5B &= ~(1<<CS50);
-		TCCR5B &= ~(1<<CS51);
-		TCCR5B &= ~(1<<CS52);
-		
-		//reset shutter compare variable
-		shutter_compare = 0;
-		inTakePicMode = false;
+		//the period ending now put out a step if the step pin was connected
+		if (pan_track_sub == 0)
+		{
+			pan_position = pan_position + pan_direction;
+			pan_track_sub = pan_track_div;
+		}
+		pan_track_sub--;
 		
+		//only the last period of a step lets its pulse out
+		if (pan_track_sub == 0)
+		{
+			TCCR1A |= (1<<COM1B1);
+		}
+		else
+		{
+			TCCR1A &= ~(1<<COM1B1);
+		}
+		return;
+	}
+	
+	if (inPanMoveMode == false)
+	{
+		return;
+	}
+	
+	pan_timer_overflow = pan_timer_overflow + 1;
+	pan_position = pan_position + pan_direction;
+	
+	if (pan_steps == pan_timer_overflow)
+	{
+		TCCR1B &= ~((1<<CS10) | (1<<CS11) | (1<<CS12));
+		OCR1A = 0;
+		pan_steps = 0;
+		inPanMoveMode = false;
+	}
+}
+
+//IR burst edges, see ir_burst.h
+ISR(TIMER3_COMPC_vect)
+{
+	ir_burst_edge();
+}
+
+//Moves the sequence on to its next table entry: the pin action for the entry is applied
+// and its count loaded. The end entry has no count, so the ISR stops there. Shutter
+// edges are time stamped straight after the pin write for the frame log.
+static inline void seq_next()
+{
+	uint8_t last = seq_table[seq_index].type;
+	uint8_t i = seq_index + 1;
+	
+	PORTL = (PORTL & ~seq_table[i].pins_clear) | seq_table[i].pins_set;
+	
+	//first shutter open
+	if (last == SEQ_FOCUS_LEAD)
+	{
+		ir_burst_start();
+
+		frame_ring[frame_ring_head].frame = seq_frame;
+		frame_ring[frame_ring_head].open_time = task_timer::isr_raw_time();
+		frame_ring[frame_ring_head].position = slide_position;
 	}
 	
-	//PicDelay Loop
-	else if ((shutter_compare == GetPicDelay()) && (inPicDelayMode == true))
+	seq_left = seq_table[i].ticks;
+	seq_entry_start = seq_time_ms;
+	seq_index = i;
+	
+	if (seq_table[i].type == SEQ_END)
 	{
-		//turn off timer by setting pre-scalar 0
-		TCCR5B &= ~(1<<CS50);
-		TCCR5B &= ~(1<<CS51);
-		TCCR5B &= ~(1<<CS52);
+		//last shutter closed, the record goes in the ring unless it is full
+		if (last == SEQ_EXPOSURE)
+		{
+			uint8_t next = (frame_ring_head + 1) & (FRAME_LOG_SIZE - 1);
+			
+			frame_ring[frame_ring_head].close_time = task_timer::isr_raw_time();
+			if (next != frame_ring_tail)
+			{
+				frame_ring_head = next;
+			}
+			else
+			{
+				frame_ring_dropped = frame_ring_dropped + 1;
+			}
+		}
 		
-		//reset shutter compare variable
-		shutter_compare = 0;
+		inTakePicMode = false;
 		inPicDelayMode = false;
-		
-	} 
-	
-	//Motor Delay Loop
-	else if ((shutter_compare == GetMotorDelay()) && (inMotorDelayMode == true))
-	{	
-		//turn off timer by setting pre-scalar 0
-		TCCR5B &= ~(1<<CS50);
-		TCCR5B &= ~(1<<CS51);
-		TCCR5B &= ~(1<<CS52);
-		
-		//reset shutter compare variable
-		shutter_compare = 0;
-		inMotorDelayMode = false;
-		
+		if (seq_focus_hold != 0)
+		{
+			focus_release_left = seq_focus_hold;
+		}
+	}
+}
+
+//Interupt routine for intervelometer. Ticks every millisecond and never stops, so
+// seq_time_ms is the time base for the fixed frame period. The phases come from the
+// table intervelometer loads before they start, so all this does is count down.
+ISR(TIMER5_COMPC_vect)
+{
+	seq_time_ms = seq_time_ms + 1;
+	
+	//Focus release runs on its own alongside whatever phase comes next
+	if (focus_release_left > 0)
+	{
+		focus_release_left = focus_release_left - 1;
+		if (focus_release_left == 0)
+		{
+			PORTL &= ~(1<<PORTL4);
+		}
+	}
+	
+	//Motor delay runs on its own too, so a move can overlap the camera's pic delay
+	if (settle_left > 0)
+	{
+		settle_left = settle_left - 1;
+		if (settle_left == 0)
+		{
+			inMotorDelayMode = false;
+		}
+	}
+	
+	if (seq_left > 0)
+	{
+		seq_left = seq_left - 1;
+		if (seq_left == 0)
+		{
+			seq_next();
+		}
+	}
+}
+
+//Sync input (camera flash sync or card busy line) on ICP5. An edge during the pic delay
+// means the camera is done, so the delay ends there instead of running its full length.
+// Every edge is time stamped for task_navigation to log.
+ISR(TIMER5_CAPT_vect)
+{
+	uint16_t icr = ICR5;
+	unsigned long ms = seq_time_ms - seq_entry_start;
+	uint8_t type = seq_table[seq_index].type;
+	
+	//the ms tick may be pending behind this interrupt
+	if ((TIFR5 & (1<<OCF5C)) && (icr < 125))
+	{
+		ms = ms + 1;
 	}
 	
+	sync_ms = ms;
+	sync_ticks = icr;
+	sync_captured = true;
 	
+	if (seq_left == 0)
+	{
+		sync_phase = SYNC_PHASE_IDLE;
+	}
+	else if ((type == SEQ_FOCUS_LEAD) || (type == SEQ_EXPOSURE))
+	{
+		sync_phase = SYNC_PHASE_EXPOSURE;
+	}
+	else if (type == SEQ_PIC_DELAY)
+	{
+		sync_phase = SYNC_PHASE_PIC_DELAY;
+		seq_next();
+	}
+	else
+	{
+		sync_phase = SYNC_PHASE_IDLE;
+	}
 }
 
 
@@ -157,6 +387,9 @@ ISR(TIMER5_COMPC_vect)
 int main ()
 {
 	char input_char;
+	long awake_start = 0;						//when the main loop last woke up
+	long sleep_start;							//when the main loop went to sleep
+	unsigned long sleeps;						//idle()'s sleep count when it did
 
 //---------------------------------Initialize Objects-------------------------------------
 	//Start serial port
@@ -182,6 +415,12 @@ int main ()
 	
 	//intervelometer object
 	intervelometer shutter(&interval , &the_serial_port , &the_timer);
+	
+	//pan axis stepper object, only used on two axis rigs
+	pan_stepper pan_motor (&interval, &the_serial_port, &the_timer);
+	
+	//emergency stop input
+	estop stop_switch (&the_serial_port);
 		
 	
 //---------------------------------TASK MENU-------------------------------------
@@ -198,19 +437,61 @@ int main ()
 	//the_serial_port <<"Menu Task Interval: " << interval_time << " sec or " 
 					 //<< interval_time.get_raw_time () << " counts" << endl;
 	
-	task_navigation	timelapse_navigation(&interval_time, &the_serial_port, &the_timer, &my_adc, &motor, &shutter);
+	task_navigation	timelapse_navigation(&interval_time, &the_serial_port, &the_timer, &my_adc, &motor, &shutter, &pan_motor, &stop_switch);
+	
+//---------------------------------TASK LOG--------------------------------------
+//run task at every 0.1 seconds, records are only written out between frames
+	interval_time.set_time (0, 100000);
+	
+	task_log	frame_log(&interval_time, &the_serial_port);
+	
+//---------------------------------SCHEDULER-------------------------------------
+//the motion task goes first, the menu can block for a button press delay
+	stl_scheduler scheduler (&the_timer, &the_serial_port);
+	scheduler.add (&timelapse_navigation, 2);
+	scheduler.add (&frame_log, 1);
+	scheduler.add (&menu_system, 0);
+	
+//the menu's button delays miss dozens of its run times, which aren't worth making up;
+//  navigation makes up a few to keep its step timing, the log just runs late
+	timelapse_navigation.set_overrun_policy (STL_OVERRUN_CATCH_UP, 4);
+	frame_log.set_overrun_policy (STL_OVERRUN_RUN_ONCE);
+	menu_system.set_overrun_policy (STL_OVERRUN_SKIP);
 	
 	sei();	//enable global interrupt
 	
 	
 	while (true)
 	{
-		//Start the task_menu task.
-		menu_system.schedule(the_timer.get_time_now());
+		//Run whichever task is most urgent
+		scheduler.run_once ();
 		
-		//Start the navigation task.
-		timelapse_navigation.schedule(the_timer.get_time_now());
-	
+		//'s' on the serial port writes out what the scheduling costs and which tasks
+		//  have been running late, 'c' starts those figures over
+		if (the_serial_port.check_for_char ())
+		{
+			input_char = the_serial_port.getchar ();
+			if (input_char == 's')
+			{
+				scheduler.print_stats (&the_serial_port);
+			}
+			else if (input_char == 'c')
+			{
+				scheduler.clear_stats ();
+			}
+		}
+		
+		//Sleep until the next task is due; wakes for interrupts in between go back to
+		//  sleep inside idle(). The time the main loop spends awake is kept for the
+		//  current estimate of low power runs, and each of those wakes adds WAKE_US
+		sleeps = scheduler.get_sleeps ();
+		sleep_start = the_timer.get_time_now().get_raw_time();
+		if (scheduler.idle ())
+		{
+			awake_us += sleep_start - awake_start;
+			awake_us += (scheduler.get_sleeps () - sleeps) * WAKE_US;
+			awake_start = the_timer.get_time_now().get_raw_time();
+		}
 
 	}
 